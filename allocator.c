@@ -0,0 +1,199 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+// 容器使用的分配器。reallocate 会收到原来的大小，
+// 方便不记录块大小的分配器（例如 arena）实现。
+typedef struct {
+    void* (*allocate)(void* context, size_t size);
+    void* (*reallocate)(void* context, void* ptr, size_t old_size, size_t new_size);
+    void (*deallocate)(void* context, void* ptr);
+    void* context;
+} allocator_t;
+
+// 容器里保存的分配器指针为 NULL 时使用 malloc/realloc/free
+void* allocator_alloc(const allocator_t* allocator, size_t size) {
+    if (allocator == NULL) {
+        return malloc(size);
+    }
+    return allocator->allocate(allocator->context, size);
+}
+
+void* allocator_realloc(const allocator_t* allocator, void* ptr, size_t old_size, size_t new_size) {
+    if (allocator == NULL) {
+        return realloc(ptr, new_size);
+    }
+    return allocator->reallocate(allocator->context, ptr, old_size, new_size);
+}
+
+void allocator_free(const allocator_t* allocator, void* ptr) {
+    if (allocator == NULL) {
+        free(ptr);
+        return;
+    }
+    allocator->deallocate(allocator->context, ptr);
+}
+
+typedef struct arena_block {
+    struct arena_block* next;
+    size_t capacity;
+    size_t used;
+    char data[];
+} arena_block_t;
+
+// 指针碰撞分配的 arena：分配只移动 used，单个释放是空操作，
+// arena_reset 以 O(1) 回收全部内存并保留已申请的块供下次复用。
+typedef struct {
+    arena_block_t* first;
+    arena_block_t* current;
+    void* last;
+    size_t block_size;
+    allocator_t allocator;
+} arena_t;
+
+arena_block_t* create_arena_block(size_t capacity) {
+    arena_block_t* block = (arena_block_t*)malloc(sizeof(arena_block_t) + capacity);
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+// 返回 block 中满足对齐的下一个可用偏移
+size_t arena_aligned_offset(arena_block_t* block) {
+    uintptr_t address = (uintptr_t)(block->data + block->used);
+    uintptr_t aligned = (address + ARENA_ALIGNMENT - 1) & ~(uintptr_t)(ARENA_ALIGNMENT - 1);
+    return block->used + (aligned - address);
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    arena_block_t* block = arena->current;
+    size_t offset = arena_aligned_offset(block);
+
+    while (offset + size > block->capacity) {
+        if (block->next == NULL) {
+            size_t capacity = arena->block_size;
+            if (capacity < size + ARENA_ALIGNMENT) {
+                capacity = size + ARENA_ALIGNMENT;
+            }
+            block->next = create_arena_block(capacity);
+        }
+        // reset 之后复用的块里还留着旧的 used，进入时才清零
+        block = block->next;
+        block->used = 0;
+        offset = arena_aligned_offset(block);
+    }
+
+    arena->current = block;
+    block->used = offset + size;
+    arena->last = block->data + offset;
+    return arena->last;
+}
+
+// 最近一次分配的内存在块内有空间时原地扩展，否则分配新内存并拷贝
+void* arena_realloc(arena_t* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL) {
+        return arena_alloc(arena, new_size);
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+
+    arena_block_t* block = arena->current;
+    if (ptr == arena->last) {
+        size_t offset = (char*)ptr - block->data;
+        if (offset + new_size <= block->capacity) {
+            block->used = offset + new_size;
+            return ptr;
+        }
+    }
+
+    void* new_ptr = arena_alloc(arena, new_size);
+    memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+void* arena_allocate(void* context, size_t size) {
+    return arena_alloc((arena_t*)context, size);
+}
+
+void* arena_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    return arena_realloc((arena_t*)context, ptr, old_size, new_size);
+}
+
+void arena_deallocate(void* context, void* ptr) {
+    (void)context;
+    (void)ptr;
+}
+
+// block_size 为 0 时使用默认块大小
+arena_t* create_arena(size_t block_size) {
+    arena_t* arena = (arena_t*)malloc(sizeof(arena_t));
+    arena->block_size = block_size == 0 ? ARENA_DEFAULT_BLOCK_SIZE : block_size;
+    arena->first = create_arena_block(arena->block_size);
+    arena->current = arena->first;
+    arena->last = NULL;
+    arena->allocator.allocate = arena_allocate;
+    arena->allocator.reallocate = arena_reallocate;
+    arena->allocator.deallocate = arena_deallocate;
+    arena->allocator.context = arena;
+    return arena;
+}
+
+// 传给 create_*_with_allocator 的分配器，生命周期与 arena 相同
+const allocator_t* arena_get_allocator(arena_t* arena) {
+    return &arena->allocator;
+}
+
+// 回收 arena 分配出去的全部内存，之前分配的指针全部失效
+void arena_reset(arena_t* arena) {
+    arena->current = arena->first;
+    arena->first->used = 0;
+    arena->last = NULL;
+}
+
+void destroy_arena(arena_t* arena) {
+    arena_block_t* block = arena->first;
+    while (block != NULL) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+// 其他文件都会 -include allocator.c，示例用单独的宏，避免和容器的 TEST main 冲突：
+//   cc -DALLOCATOR_TEST allocator.c -o test_allocator
+#if defined(ALLOCATOR_TEST)
+#include <stdio.h>
+
+int main() {
+    arena_t* arena = create_arena(256);
+
+    for (int round = 0; round < 2; round++) {
+        int* numbers = (int*)arena_alloc(arena, sizeof(int) * 4);
+        for (int i = 0; i < 4; i++) {
+            numbers[i] = i * (round + 1);
+        }
+
+        // 最近一次分配原地扩展
+        int* grown = (int*)arena_realloc(arena, numbers, sizeof(int) * 4, sizeof(int) * 8);
+        printf("round %d: grown in place %d, ", round, grown == numbers);
+
+        // 超过块大小的分配会单独申请一个块
+        char* large = (char*)arena_alloc(arena, 1000);
+        memset(large, 'x', 1000);
+
+        printf("numbers %d %d %d %d\n", grown[0], grown[1], grown[2], grown[3]);
+        arena_reset(arena);
+    }
+
+    destroy_arena(arena);
+
+    return 0;
+}
+#endif
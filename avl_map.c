@@ -6,16 +6,43 @@ typedef struct avl_node {
     struct avl_node* left;
     struct avl_node* right;
     int (*compare)(const void*, const void*);
+    const allocator_t* allocator;
+#if defined(CONTAINER_STATS)
+    avl_stats* stats;
+#endif
 } avl_node_t;
 
-avl_node_t* create_node(void* key, void* value, int (*compare)(const void*, const void*)) {
-    avl_node_t* node = (avl_node_t*)malloc(sizeof(avl_node_t));
+// 之后插入的节点都沿用根节点的 allocator，allocator 为 NULL 时使用 malloc
+avl_node_t* create_node_with_allocator(void* key, void* value, int (*compare)(const void*, const void*),
+                                       const allocator_t* allocator) {
+    avl_node_t* node = (avl_node_t*)allocator_alloc(allocator, sizeof(avl_node_t));
     node->key = key;
     node->value = value;
     node->height = 1;
     node->left = NULL;
     node->right = NULL;
     node->compare = compare;
+    node->allocator = allocator;
+#if defined(CONTAINER_STATS)
+    node->stats = NULL;
+#endif
+    return node;
+}
+
+avl_node_t* create_node(void* key, void* value, int (*compare)(const void*, const void*)) {
+    return create_node_with_allocator(key, value, compare, NULL);
+}
+
+// 比较函数存放在节点里，空子树没有比较函数可用，新节点只能由父节点创建，
+// 并沿用父节点的比较函数、allocator 和统计
+avl_node_t* create_child_node(avl_node_t* parent, void* key, void* value) {
+    avl_node_t* node = create_node_with_allocator(key, value, parent->compare, parent->allocator);
+#if defined(CONTAINER_STATS)
+    node->stats = parent->stats;
+    if (node->stats != NULL) {
+        node->stats->inserts++;
+    }
+#endif
     return node;
 }
 
@@ -56,6 +83,11 @@ avl_node_t* rotate_left(avl_node_t* node) {
     right_child->left = node;
     update_height(node);
     update_height(right_child);
+#if defined(CONTAINER_STATS)
+    if (node->stats != NULL) {
+        node->stats->rotations++;
+    }
+#endif
     return right_child;
 }
 
@@ -65,40 +97,71 @@ avl_node_t* rotate_right(avl_node_t* node) {
     left_child->right = node;
     update_height(node);
     update_height(left_child);
+#if defined(CONTAINER_STATS)
+    if (node->stats != NULL) {
+        node->stats->rotations++;
+    }
+#endif
     return left_child;
 }
 
+#if defined(CONTAINER_STATS)
+avl_node_t* record_rebalance(avl_node_t* node, int height_before) {
+    if (node->stats != NULL) {
+        node->stats->rebalances++;
+        container_event_emit(&node->stats->hook, CONTAINER_EVENT_AVL_REBALANCE, node->stats,
+                             height_before, node->height, 0);
+    }
+    return node;
+}
+#endif
+
 avl_node_t* balance_node(avl_node_t* node) {
     update_height(node);
     int balance_factor = get_balance_factor(node);
+#if defined(CONTAINER_STATS)
+    int height_before = node->height;
+#endif
 
     if (balance_factor > 1) {
         if (get_balance_factor(node->left) < 0) {
             node->left = rotate_left(node->left);
         }
+#if defined(CONTAINER_STATS)
+        return record_rebalance(rotate_right(node), height_before);
+#else
         return rotate_right(node);
+#endif
     }
 
     if (balance_factor < -1) {
         if (get_balance_factor(node->right) > 0) {
             node->right = rotate_right(node->right);
         }
+#if defined(CONTAINER_STATS)
+        return record_rebalance(rotate_left(node), height_before);
+#else
         return rotate_left(node);
+#endif
     }
 
     return node;
 }
 
+// 比较函数存放在节点里，空树拿不到比较函数，所以树要先用 create_node 创建根节点。
+// 删光所有键后 root 为 NULL，这时插入什么也不做，返回 NULL，需要重新 create_node
 avl_node_t* insert_node(avl_node_t* root, void* key, void* value) {
     if (root == NULL) {
-        return create_node(key, value, root->compare);
+        return NULL;
     }
 
     int cmp = root->compare(key, root->key);
     if (cmp < 0) {
-        root->left = insert_node(root->left, key, value);
+        root->left = root->left != NULL ? insert_node(root->left, key, value)
+                                        : create_child_node(root, key, value);
     } else if (cmp > 0) {
-        root->right = insert_node(root->right, key, value);
+        root->right = root->right != NULL ? insert_node(root->right, key, value)
+                                          : create_child_node(root, key, value);
     } else {
         root->value = value;
         return root;
@@ -136,6 +199,11 @@ avl_node_t* delete_node(avl_node_t* root, void* key) {
         // Node found, perform deletion
         if (root->left == NULL || root->right == NULL) {
             avl_node_t* temp = root->left ? root->left : root->right;
+#if defined(CONTAINER_STATS)
+            if (root->stats != NULL) {
+                root->stats->deletes++;
+            }
+#endif
 
             if (temp == NULL) {
                 temp = root;
@@ -144,7 +212,7 @@ avl_node_t* delete_node(avl_node_t* root, void* key) {
                 *root = *temp;
             }
 
-            free(temp);
+            allocator_free(temp->allocator, temp);
         } else {
             avl_node_t* temp = get_min_node(root->right);
             root->key = temp->key;
@@ -169,7 +237,91 @@ void destroy_node(avl_node_t* node) {
 
     destroy_node(node->left);
     destroy_node(node->right);
-    free(node);
+    allocator_free(node->allocator, node);
     node = NULL;
 }
 
+
+#if defined(CONTAINER_STATS)
+// 给已有的树挂上统计，之后插入的节点自动沿用。stats 由调用方持有，需要先清零
+void avl_set_stats(avl_node_t* root, avl_stats* stats) {
+    if (root == NULL) {
+        return;
+    }
+    root->stats = stats;
+    avl_set_stats(root->left, stats);
+    avl_set_stats(root->right, stats);
+}
+
+// 每次旋转后回调 callback
+void avl_stats_set_event_callback(avl_stats* stats, container_event_callback callback, void* context) {
+    stats->hook.callback = callback;
+    stats->hook.context = context;
+}
+
+// rotations 包括插入和删除两边的旋转，rotations_per_op 按插入加删除的次数平均
+void avl_stats_dump(avl_node_t* root, FILE* out) {
+    const avl_stats* stats = root != NULL ? root->stats : NULL;
+    if (stats == NULL) {
+        return;
+    }
+
+    size_t ops = stats->inserts + stats->deletes;
+    fprintf(out, "{\"container\":\"avl_map\",\"height\":%d,\"inserts\":%zu,\"deletes\":%zu,"
+                 "\"rotations\":%zu,\"rebalances\":%zu,\"rotations_per_op\":%.3f}\n",
+            get_height(root), stats->inserts, stats->deletes, stats->rotations, stats->rebalances,
+            ops ? (double)stats->rotations / ops : 0.0);
+}
+#endif
+
+#if defined(BENCH)
+int u64_compare(const void* key1, const void* key2) {
+    unsigned long long a = *(const unsigned long long*)key1;
+    unsigned long long b = *(const unsigned long long*)key2;
+    return (a > b) - (a < b);
+}
+
+int main() {
+    for (int dist = 0; dist < BENCH_DIST_COUNT; dist++) {
+        unsigned long long* keys = bench_keys((bench_dist)dist, BENCH_OPS, BENCH_OPS, 1);
+        unsigned long long* lookups = bench_keys((bench_dist)dist, BENCH_OPS, BENCH_OPS, 2);
+        bench_run run;
+
+        bench_begin(&run, "avl_map", "insert", bench_dist_names[dist]);
+        avl_node_t* root = create_node(&keys[0], &keys[0], u64_compare);
+#if defined(CONTAINER_STATS)
+        avl_stats stats;
+        memset(&stats, 0, sizeof(stats));
+        avl_set_stats(root, &stats);
+#endif
+        for (size_t i = 1; i < BENCH_OPS; i++) {
+            root = insert_node(root, &keys[i], &keys[i]);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        size_t hits = 0;
+        bench_begin(&run, "avl_map", "find", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            hits += find_value(root, &lookups[i]) != NULL;
+        }
+        bench_end(&run, BENCH_OPS);
+        fprintf(stderr, "avl_map %s: height %d, find hit rate %.3f\n",
+                bench_dist_names[dist], root->height, (double)hits / BENCH_OPS);
+
+        bench_begin(&run, "avl_map", "delete", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS / 2; i++) {
+            root = delete_node(root, &lookups[i]);
+        }
+        bench_end(&run, BENCH_OPS / 2);
+#if defined(CONTAINER_STATS)
+        avl_stats_dump(root, stderr);
+#endif
+
+        destroy_node(root);
+        free(lookups);
+        free(keys);
+    }
+
+    return 0;
+}
+#endif
@@ -0,0 +1,13 @@
+# 由 bench_json 目标调用：依次运行 BENCHES 里的基准程序（用 | 分隔），
+# 把每个程序输出的 JSON 行汇总写入 OUTPUT。
+string(REPLACE "|" ";" BENCHES "${BENCHES}")
+file(WRITE ${OUTPUT} "")
+foreach(bench ${BENCHES})
+    message(STATUS "running ${bench}")
+    execute_process(COMMAND ${bench} OUTPUT_VARIABLE output RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${bench} failed: ${result}")
+    endif()
+    file(APPEND ${OUTPUT} "${output}")
+endforeach()
+message(STATUS "results written to ${OUTPUT}")
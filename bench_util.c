@@ -0,0 +1,156 @@
+// 各容器 BENCH 入口共用的计时、键分布、分配计数和 JSON 输出。
+// 用 -include 放在容器源文件之前编译，例如：
+//   cc -O2 -DBENCH -include bench_util.c -include allocator.c hashmap.c -o bench_hashmap
+// 每个测量项输出一行 JSON，便于在不同版本之间对比。
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+#include <sys/resource.h>
+
+#if !defined(BENCH_OPS)
+#define BENCH_OPS (1 << 20)
+#endif
+
+#define BENCH_ZIPF_THETA 0.99
+
+typedef enum {
+    BENCH_DIST_SEQUENTIAL,
+    BENCH_DIST_UNIFORM,
+    BENCH_DIST_ZIPFIAN,
+    BENCH_DIST_COUNT
+} bench_dist;
+
+const char* bench_dist_names[BENCH_DIST_COUNT] = {"sequential", "uniform", "zipfian"};
+
+size_t bench_alloc_count = 0;
+size_t bench_realloc_count = 0;
+
+void* bench_malloc(size_t size) {
+    bench_alloc_count++;
+    return malloc(size);
+}
+
+void* bench_realloc(void* ptr, size_t size) {
+    bench_realloc_count++;
+    return realloc(ptr, size);
+}
+
+double bench_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 进程到目前为止的峰值常驻内存（KB）
+long bench_peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+unsigned long long bench_random(unsigned long long* state) {
+    unsigned long long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// 打散排名，让热点键不会集中在相邻的位置
+unsigned long long bench_scramble(unsigned long long x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// 生成 count 个取值在 [0, key_space) 的键，调用方用 free 释放。
+// zipfian 按 Gray 等人的方法生成排名，再打散到整个键空间。
+unsigned long long* bench_keys(bench_dist dist, size_t count, size_t key_space, unsigned long long seed) {
+    unsigned long long* keys = (unsigned long long*)malloc(sizeof(unsigned long long) * count);
+    unsigned long long state = seed | 1;
+
+    if (dist == BENCH_DIST_SEQUENTIAL) {
+        for (size_t i = 0; i < count; i++) {
+            keys[i] = i % key_space;
+        }
+        return keys;
+    }
+
+    if (dist == BENCH_DIST_UNIFORM) {
+        for (size_t i = 0; i < count; i++) {
+            keys[i] = bench_random(&state) % key_space;
+        }
+        return keys;
+    }
+
+    double zeta_n = 0;
+    for (size_t i = 1; i <= key_space; i++) {
+        zeta_n += 1.0 / pow((double)i, BENCH_ZIPF_THETA);
+    }
+    double zeta_2 = 1.0 + 1.0 / pow(2.0, BENCH_ZIPF_THETA);
+    double alpha = 1.0 / (1.0 - BENCH_ZIPF_THETA);
+    double eta = (1.0 - pow(2.0 / key_space, 1.0 - BENCH_ZIPF_THETA)) / (1.0 - zeta_2 / zeta_n);
+
+    for (size_t i = 0; i < count; i++) {
+        double u = (bench_random(&state) >> 11) * (1.0 / 9007199254740992.0);
+        double uz = u * zeta_n;
+        unsigned long long rank;
+        if (uz < 1.0) {
+            rank = 0;
+        } else if (uz < zeta_2) {
+            rank = 1;
+        } else {
+            rank = (unsigned long long)(key_space * pow(eta * u - eta + 1.0, alpha));
+            if (rank >= key_space) {
+                rank = key_space - 1;
+            }
+        }
+        keys[i] = bench_scramble(rank) % key_space;
+    }
+    return keys;
+}
+
+typedef struct {
+    const char* container;
+    const char* op;
+    const char* dist;
+    int threads;
+    size_t allocs;
+    size_t reallocs;
+    double start;
+} bench_run;
+
+void bench_begin(bench_run* run, const char* container, const char* op, const char* dist) {
+    run->container = container;
+    run->op = op;
+    run->dist = dist;
+    run->threads = 1;
+    run->allocs = bench_alloc_count;
+    run->reallocs = bench_realloc_count;
+    run->start = bench_now();
+}
+
+void bench_end(bench_run* run, size_t ops) {
+    double elapsed = bench_now() - run->start;
+    printf("{\"container\":\"%s\",\"op\":\"%s\",\"dist\":\"%s\",\"threads\":%d,"
+           "\"ops\":%zu,\"ns_per_op\":%.2f,\"ops_per_sec\":%.0f,"
+           "\"allocs\":%zu,\"reallocs\":%zu,\"peak_rss_kb\":%ld}\n",
+           run->container, run->op, run->dist, run->threads,
+           ops, ops ? elapsed * 1e9 / ops : 0.0, elapsed > 0 ? ops / elapsed : 0.0,
+           bench_alloc_count - run->allocs, bench_realloc_count - run->reallocs,
+           bench_peak_rss_kb());
+    fflush(stdout);
+}
+
+// 之后编译的容器代码里的 malloc/realloc 都会被计数
+#define malloc(size) bench_malloc(size)
+#define realloc(ptr, size) bench_realloc(ptr, size)
@@ -0,0 +1,114 @@
+// 容器内部统计与事件回调，只在定义了 CONTAINER_STATS 时编译进来，
+// 未定义时各容器里的统计代码和字段全部去掉，没有任何开销。
+// 启用方式：cc -DCONTAINER_STATS -include container_stats.c ...
+
+#if defined(CONTAINER_STATS)
+#include <stdio.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#define STATS_PROBE_BUCKETS 16
+
+typedef enum {
+    CONTAINER_EVENT_HASHMAP_RESIZE,   // before/after 为扩容前后的槽位数
+    CONTAINER_EVENT_AVL_REBALANCE,    // before/after 为旋转前后子树的高度
+    CONTAINER_EVENT_ARRAY_REALLOC,    // before/after 为扩容前后的容量（元素个数）
+    CONTAINER_EVENT_STRING_REALLOC    // before/after 为扩容前后的容量（字符个数）
+} container_event_type;
+
+typedef struct {
+    container_event_type type;
+    const void* instance;
+    size_t before;
+    size_t after;
+    unsigned long long duration_ns;
+} container_event;
+
+typedef void (*container_event_callback)(const container_event* event, void* context);
+
+typedef struct {
+    container_event_callback callback;
+    void* context;
+} container_event_hook;
+
+unsigned long long stats_now_ns() {
+#if defined(_WIN32)
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (unsigned long long)(counter.QuadPart * 1000000000.0 / frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+void container_event_emit(const container_event_hook* hook, container_event_type type, const void* instance,
+                          size_t before, size_t after, unsigned long long duration_ns) {
+    if (hook->callback == NULL) {
+        return;
+    }
+    container_event event;
+    event.type = type;
+    event.instance = instance;
+    event.before = before;
+    event.after = after;
+    event.duration_ns = duration_ns;
+    hook->callback(&event, hook->context);
+}
+
+typedef struct {
+    size_t puts;
+    size_t gets;
+    // 每次查找多探测的槽位数，最后一个桶统计 STATS_PROBE_BUCKETS - 1 及以上
+    size_t probe_histogram[STATS_PROBE_BUCKETS];
+    size_t total_probes;
+    size_t max_probe;
+    size_t resizes;
+    unsigned long long resize_ns;
+    container_event_hook hook;
+} hashmap_stats;
+
+void hashmap_stats_record_probe(hashmap_stats* stats, size_t probes) {
+    stats->probe_histogram[probes < STATS_PROBE_BUCKETS ? probes : STATS_PROBE_BUCKETS - 1]++;
+    stats->total_probes += probes;
+    if (probes > stats->max_probe) {
+        stats->max_probe = probes;
+    }
+}
+
+// 一棵 AVL 树共用一份，由调用方持有
+typedef struct {
+    size_t inserts;
+    size_t deletes;
+    size_t rotations;
+    size_t rebalances;
+    container_event_hook hook;
+} avl_stats;
+
+// dynamic_array 与 dynamic_string 共用
+typedef struct {
+    size_t reallocs;
+    size_t moves;           // realloc 返回了新地址的次数
+    size_t bytes_copied;    // 搬迁时需要拷贝的已用字节数
+    container_event_hook hook;
+} buffer_stats;
+
+void buffer_stats_record_realloc(buffer_stats* stats, const void* old_data, const void* new_data, size_t used_bytes) {
+    stats->reallocs++;
+    if (old_data != NULL && old_data != new_data) {
+        stats->moves++;
+        stats->bytes_copied += used_bytes;
+    }
+}
+
+void buffer_stats_dump(const char* container, const buffer_stats* stats, size_t capacity, FILE* out) {
+    fprintf(out, "{\"container\":\"%s\",\"capacity\":%zu,\"reallocs\":%zu,\"moves\":%zu,\"bytes_copied\":%zu}\n",
+            container, capacity, stats->reallocs, stats->moves, stats->bytes_copied);
+}
+#endif
@@ -3,25 +3,48 @@ typedef struct {
     size_t element_size;
     size_t capacity;
     size_t size;
+    const allocator_t* allocator;
+#if defined(CONTAINER_STATS)
+    buffer_stats stats;
+#endif
 } dynamic_array;
 
-dynamic_array* create_dynamic_array(size_t element_size) {
-    dynamic_array* array = (dynamic_array*)malloc(sizeof(dynamic_array));
+// allocator 为 NULL 时使用 malloc/realloc/free
+dynamic_array* create_dynamic_array_with_allocator(size_t element_size, const allocator_t* allocator) {
+    dynamic_array* array = (dynamic_array*)allocator_alloc(allocator, sizeof(dynamic_array));
     array->data = NULL;
     array->element_size = element_size;
     array->capacity = 0;
     array->size = 0;
+    array->allocator = allocator;
+#if defined(CONTAINER_STATS)
+    memset(&array->stats, 0, sizeof(array->stats));
+#endif
     return array;
 }
 
+dynamic_array* create_dynamic_array(size_t element_size) {
+    return create_dynamic_array_with_allocator(element_size, NULL);
+}
+
 void destroy_dynamic_array(dynamic_array* array) {
-    free(array->data);
-    free(array);
+    allocator_free(array->allocator, array->data);
+    allocator_free(array->allocator, array);
 }
 
 void resize_dynamic_array(dynamic_array* array, size_t new_capacity) {
-    array->data = realloc(array->data, new_capacity * array->element_size);
+#if defined(CONTAINER_STATS)
+    void* old_data = array->data;
+    size_t old_capacity = array->capacity;
+#endif
+    array->data = allocator_realloc(array->allocator, array->data,
+                                    array->capacity * array->element_size,
+                                    new_capacity * array->element_size);
     array->capacity = new_capacity;
+#if defined(CONTAINER_STATS)
+    buffer_stats_record_realloc(&array->stats, old_data, array->data, array->size * array->element_size);
+    container_event_emit(&array->stats.hook, CONTAINER_EVENT_ARRAY_REALLOC, array, old_capacity, new_capacity, 0);
+#endif
 }
 
 void push_back_dynamic_array(dynamic_array* array, void* element) {
@@ -34,6 +57,25 @@ void push_back_dynamic_array(dynamic_array* array, void* element) {
     array->size++;
 }
 
+// 一次追加 count 个连续元素，最多只扩容一次
+void push_back_n_dynamic_array(dynamic_array* array, const void* elements, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    size_t new_size = array->size + count;
+    if (new_size > array->capacity) {
+        size_t new_capacity = array->capacity == 0 ? 1 : array->capacity * 2;
+        while (new_capacity < new_size) {
+            new_capacity *= 2;
+        }
+        resize_dynamic_array(array, new_capacity);
+    }
+    void* destination = (char*)array->data + array->size * array->element_size;
+    memcpy(destination, elements, count * array->element_size);
+    array->size = new_size;
+}
+
 void* get_dynamic_array_element(dynamic_array* array, size_t index) {
     if (index >= array->size) {
         return NULL;
@@ -52,6 +94,18 @@ size_t calculate_total_size(dynamic_array* array) {
     return array->size * array->element_size;
 }
 
+#if defined(CONTAINER_STATS)
+// 每次扩容后回调 callback
+void dynamic_array_set_event_callback(dynamic_array* array, container_event_callback callback, void* context) {
+    array->stats.hook.callback = callback;
+    array->stats.hook.context = context;
+}
+
+void dynamic_array_stats_dump(const dynamic_array* array, FILE* out) {
+    buffer_stats_dump("dynamic_array", &array->stats, array->capacity, out);
+}
+#endif
+
 #if defined(TEST)
 int main() {
     // 创建一个存储整数的动态数组
@@ -59,20 +113,20 @@ int main() {
 
     // 添加元素到动态数组
     int element1 = 10;
-    push_back_dynamic_array(int_array, &amp;element1);
+    push_back_dynamic_array(int_array, &element1);
 
     int element2 = 20;
-    push_back_dynamic_array(int_array, &amp;element2);
+    push_back_dynamic_array(int_array, &element2);
 
     // 获取动态数组的元素
     int* retrieved_element1 = (int*)get_dynamic_array_element(int_array, 0);
     if (retrieved_element1 != NULL) {
-        printf(“Element at index 0: %d\n“, *retrieved_element1);
+        printf("Element at index 0: %d\n", *retrieved_element1);
     }
 
     int* retrieved_element2 = (int*)get_dynamic_array_element(int_array, 1);
     if (retrieved_element2 != NULL) {
-        printf(“Element at index 1: %d\n“, *retrieved_element2);
+        printf("Element at index 1: %d\n", *retrieved_element2);
     }
 
     // 销毁动态数组
@@ -82,3 +136,55 @@ int main() {
 }
 #endif
 
+
+#if defined(BENCH)
+#define BENCH_BATCH_SIZE 256
+
+unsigned long long traverse_sum = 0;
+
+void sum_element(void* element) {
+    traverse_sum += *(unsigned long long*)element;
+}
+
+int main() {
+    bench_run run;
+
+    for (int dist = 0; dist < BENCH_DIST_COUNT; dist++) {
+        unsigned long long* values = bench_keys((bench_dist)dist, BENCH_OPS, BENCH_OPS, 1);
+
+        dynamic_array* array = create_dynamic_array(sizeof(unsigned long long));
+        bench_begin(&run, "dynamic_array", "push_back", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            push_back_dynamic_array(array, &values[i]);
+        }
+        bench_end(&run, BENCH_OPS);
+        destroy_dynamic_array(array);
+
+        array = create_dynamic_array(sizeof(unsigned long long));
+        bench_begin(&run, "dynamic_array", "push_back_n", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i += BENCH_BATCH_SIZE) {
+            size_t count = BENCH_OPS - i < BENCH_BATCH_SIZE ? BENCH_OPS - i : BENCH_BATCH_SIZE;
+            push_back_n_dynamic_array(array, &values[i], count);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        // 按分布生成的值作下标随机读取
+        unsigned long long sum = 0;
+        bench_begin(&run, "dynamic_array", "get", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            sum += *(unsigned long long*)get_dynamic_array_element(array, values[i]);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        bench_begin(&run, "dynamic_array", "traverse", bench_dist_names[dist]);
+        traverse_dynamic_array(array, sum_element);
+        bench_end(&run, BENCH_OPS);
+        fprintf(stderr, "dynamic_array %s: checksum %llu\n", bench_dist_names[dist], sum + traverse_sum);
+
+        destroy_dynamic_array(array);
+        free(values);
+    }
+
+    return 0;
+}
+#endif
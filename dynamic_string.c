@@ -4,26 +4,55 @@ typedef struct {
     size_t capacity;
     size_t length;
     int is_wide;
+    const allocator_t* allocator;
+#if defined(CONTAINER_STATS)
+    buffer_stats stats;
+#endif
 } dynamic_string;
 
-dynamic_string* create_dynamic_string(int is_wide) {
-    dynamic_string* str = (dynamic_string*)malloc(sizeof(dynamic_string));
+// allocator 为 NULL 时使用 malloc/realloc/free；split_string 返回的 token 也从它分配
+dynamic_string* create_dynamic_string_with_allocator(int is_wide, const allocator_t* allocator) {
+    dynamic_string* str = (dynamic_string*)allocator_alloc(allocator, sizeof(dynamic_string));
     str->data = NULL;
     str->element_size = is_wide ? sizeof(wchar_t) : sizeof(char);
     str->capacity = 0;
     str->length = 0;
     str->is_wide = is_wide;
+    str->allocator = allocator;
+#if defined(CONTAINER_STATS)
+    memset(&str->stats, 0, sizeof(str->stats));
+#endif
     return str;
 }
 
+dynamic_string* create_dynamic_string(int is_wide) {
+    return create_dynamic_string_with_allocator(is_wide, NULL);
+}
+
 void destroy_dynamic_string(dynamic_string* str) {
-    free(str->data);
-    free(str);
+    allocator_free(str->allocator, str->data);
+    allocator_free(str->allocator, str);
+}
+
+#if defined(CONTAINER_STATS)
+void record_dynamic_string_realloc(dynamic_string* str, const void* old_data, size_t old_capacity) {
+    buffer_stats_record_realloc(&str->stats, old_data, str->data, str->length * str->element_size);
+    container_event_emit(&str->stats.hook, CONTAINER_EVENT_STRING_REALLOC, str, old_capacity, str->capacity, 0);
 }
+#endif
 
 void resize_dynamic_string(dynamic_string* str, size_t new_capacity) {
-    str->data = realloc(str->data, new_capacity * str->element_size);
+#if defined(CONTAINER_STATS)
+    void* old_data = str->data;
+    size_t old_capacity = str->capacity;
+#endif
+    str->data = allocator_realloc(str->allocator, str->data,
+                                  str->capacity * str->element_size,
+                                  new_capacity * str->element_size);
     str->capacity = new_capacity;
+#if defined(CONTAINER_STATS)
+    record_dynamic_string_realloc(str, old_data, old_capacity);
+#endif
 }
 
 void append_dynamic_string(dynamic_string* str, const void* source) {
@@ -47,13 +76,22 @@ void append_dynamic_string_n(dynamic_string* str, const void* data, size_t lengt
     size_t new_length = str->length + length;
     if (new_length > str->capacity) {
         size_t new_capacity = (new_length + 1) * 2;
-        void* new_data = realloc(str->data, new_capacity * str->element_size);
+        void* new_data = allocator_realloc(str->allocator, str->data,
+                                           str->capacity * str->element_size,
+                                           new_capacity * str->element_size);
         if (new_data == NULL) {
             // 处理内存分配失败的情况
             return;
         }
+#if defined(CONTAINER_STATS)
+        void* old_data = str->data;
+        size_t old_capacity = str->capacity;
+#endif
         str->data = new_data;
         str->capacity = new_capacity;
+#if defined(CONTAINER_STATS)
+        record_dynamic_string_realloc(str, old_data, old_capacity);
+#endif
     }
 
     memcpy((char*)str->data + str->length * str->element_size, data, length * str->element_size);
@@ -123,8 +161,9 @@ void split_string(dynamic_string* str, const void* delimiter, size_t* num_tokens
         if (is_token) {
             size_t token_len = end - start;
             if (token_len > 0) {
-                temp_tokens = realloc(temp_tokens, (count + 1) * sizeof(void*));
-                temp_tokens[count] = malloc(token_len * sub_size);
+                temp_tokens = allocator_realloc(str->allocator, temp_tokens, count * sizeof(void*),
+                                                (count + 1) * sizeof(void*));
+                temp_tokens[count] = allocator_alloc(str->allocator, token_len * sub_size);
                 memcpy(temp_tokens[count], (const char*)str_data + start * sub_size, token_len * sub_size);
                 count++;
             }
@@ -168,7 +207,7 @@ void replace_substring(dynamic_string* str, const void* old_substring, const voi
     const void* str_data = str->data;
     size_t str_len = str->length;
 
-    dynamic_string* temp_str = create_dynamic_string(str->is_wide);
+    dynamic_string* temp_str = create_dynamic_string_with_allocator(str->is_wide, str->allocator);
     size_t start = 0;
     size_t end = 0;
 
@@ -216,11 +255,271 @@ void replace_substring(dynamic_string* str, const void* old_substring, const voi
     append_dynamic_string_n(temp_str, str_data + start, str_len - start);
 
     // 更新原始字符串
-    free(str->data);  // 释放原始字符串的内存
+    allocator_free(str->allocator, str->data);  // 释放原始字符串的内存
     str->data = temp_str->data;
     str->capacity = temp_str->capacity;
     str->length = temp_str->length;
 
     // 释放临时字符串
-    free(temp_str);
+    allocator_free(str->allocator, temp_str);
+}
+
+
+#define U64_FORMAT_MAX_DIGITS 64
+
+const char decimal_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+const unsigned long long decimal_powers[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+const char lower_digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+const char upper_digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// value 的二进制位数，value 为 0 时返回 1
+unsigned int bit_length_u64(unsigned long long value) {
+    value |= 1;
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index + 1;
+#else
+    return 64 - __builtin_clzll(value);
+#endif
+}
+
+// 十进制位数：先由二进制位数估算 log10（1233/4096 ≈ log10(2)），再查一次表修正
+unsigned int decimal_length_u64(unsigned long long value) {
+    unsigned int t = (bit_length_u64(value) * 1233) >> 12;
+    return t + 1 - ((value | 1) < decimal_powers[t]);
+}
+
+unsigned int u64_length(unsigned long long value, unsigned int base) {
+    if (base == 10) {
+        return decimal_length_u64(value);
+    }
+    if ((base & (base - 1)) == 0) {
+        unsigned int shift = bit_length_u64(base - 1);
+        return (bit_length_u64(value) + shift - 1) / shift;
+    }
+
+    unsigned int length = 1;
+    while (value >= base) {
+        value /= base;
+        length++;
+    }
+    return length;
+}
+
+// 从 dst + length 往前写 length 个数字字符
+void write_u64(char* dst, unsigned int length, unsigned long long value, unsigned int base, const char* digits) {
+    char* p = dst + length;
+
+    if (base == 10) {
+        // 每次除以 100，一次写两位
+        while (value >= 100) {
+            unsigned int pair = (unsigned int)(value % 100) * 2;
+            value /= 100;
+            p -= 2;
+            memcpy(p, decimal_digit_pairs + pair, 2);
+        }
+        if (value >= 10) {
+            p -= 2;
+            memcpy(p, decimal_digit_pairs + value * 2, 2);
+        } else {
+            *--p = (char)('0' + value);
+        }
+        return;
+    }
+
+    if ((base & (base - 1)) == 0) {
+        unsigned int shift = bit_length_u64(base - 1);
+        while (p != dst) {
+            *--p = digits[value & (base - 1)];
+            value >>= shift;
+        }
+        return;
+    }
+
+    while (p != dst) {
+        *--p = digits[value % base];
+        value /= base;
+    }
+}
+
+void reserve_dynamic_string(dynamic_string* str, size_t min_capacity) {
+    if (min_capacity <= str->capacity) {
+        return;
+    }
+    size_t new_capacity = str->capacity == 0 ? 1 : str->capacity * 2;
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+    resize_dynamic_string(str, new_capacity);
+}
+
+// 追加 [sign][pad...][digits]，不经过格式串和临时字符串。
+// 窄字符串直接写进预留好的空间，宽字符串先写到栈上再逐个扩展。
+void append_formatted_u64(dynamic_string* str, unsigned long long value, unsigned int base,
+                          size_t width, char pad, char sign, const char* digits) {
+    if (base < 2 || base > 36) {
+        return;
+    }
+
+    unsigned int length = u64_length(value, base);
+    size_t prefix = sign != 0;
+    size_t total = prefix + length;
+    size_t padding = width > total ? width - total : 0;
+    total += padding;
+
+    reserve_dynamic_string(str, str->length + total + 1);
+
+    if (!str->is_wide) {
+        char* dst = (char*)str->data + str->length;
+        if (prefix) {
+            *dst++ = sign;
+        }
+        memset(dst, pad, padding);
+        write_u64(dst + padding, length, value, base, digits);
+        dst[padding + length] = '\0';
+    } else {
+        char buffer[U64_FORMAT_MAX_DIGITS];
+        wchar_t* dst = (wchar_t*)str->data + str->length;
+        write_u64(buffer, length, value, base, digits);
+        if (prefix) {
+            *dst++ = (wchar_t)sign;
+        }
+        for (size_t i = 0; i < padding; i++) {
+            *dst++ = (wchar_t)pad;
+        }
+        for (unsigned int i = 0; i < length; i++) {
+            *dst++ = (wchar_t)buffer[i];
+        }
+        *dst = L'\0';
+    }
+
+    str->length += total;
+}
+
+// 以 base（2 到 36）进制追加无符号整数，字母小写
+void dynamic_string_append_u64(dynamic_string* str, unsigned long long value, unsigned int base) {
+    append_formatted_u64(str, value, base, 0, 0, 0, lower_digits);
+}
+
+void dynamic_string_append_i64(dynamic_string* str, long long value) {
+    if (value < 0) {
+        append_formatted_u64(str, 0ULL - (unsigned long long)value, 10, 0, 0, '-', lower_digits);
+    } else {
+        append_formatted_u64(str, (unsigned long long)value, 10, 0, 0, 0, lower_digits);
+    }
+}
+
+void dynamic_string_append_hex64(dynamic_string* str, unsigned long long value, int uppercase) {
+    append_formatted_u64(str, value, 16, 0, 0, 0, uppercase ? upper_digits : lower_digits);
+}
+
+// 不足 width 个字符时在数字前补 pad，例如 width 为 8、pad 为 '0' 相当于 "%08llu"
+void dynamic_string_append_u64_padded(dynamic_string* str, unsigned long long value, unsigned int base,
+                                      size_t width, char pad) {
+    append_formatted_u64(str, value, base, width, pad, 0, lower_digits);
+}
+
+#if defined(CONTAINER_STATS)
+// 每次扩容后回调 callback
+void dynamic_string_set_event_callback(dynamic_string* str, container_event_callback callback, void* context) {
+    str->stats.hook.callback = callback;
+    str->stats.hook.context = context;
+}
+
+void dynamic_string_stats_dump(const dynamic_string* str, FILE* out) {
+    buffer_stats_dump("dynamic_string", &str->stats, str->capacity, out);
+}
+#endif
+
+#if defined(TEST)
+int main() {
+    dynamic_string* str = create_dynamic_string(0);
+
+    dynamic_string_append_u64(str, 18446744073709551615ULL, 10);
+    append_dynamic_string(str, " ");
+    dynamic_string_append_i64(str, -9223372036854775807LL - 1);
+    append_dynamic_string(str, " ");
+    dynamic_string_append_hex64(str, 0xdeadbeefULL, 1);
+    append_dynamic_string(str, " ");
+    dynamic_string_append_u64(str, 5, 2);
+    append_dynamic_string(str, " ");
+    dynamic_string_append_u64_padded(str, 42, 10, 8, '0');
+
+    printf("%.*s\n", (int)str->length, (const char*)get_dynamic_string_data(str));
+
+    destroy_dynamic_string(str);
+
+    return 0;
+}
+#endif
+
+#if defined(BENCH)
+int main() {
+    unsigned long long* values = (unsigned long long*)malloc(sizeof(unsigned long long) * BENCH_OPS);
+    unsigned long long state = 1;
+    for (size_t i = 0; i < BENCH_OPS; i++) {
+        // 右移随机位数让各种长度的数字都出现
+        unsigned long long x = bench_random(&state);
+        values[i] = x >> (x % 64);
+    }
+    bench_run run;
+
+    dynamic_string* str = create_dynamic_string(0);
+    bench_begin(&run, "dynamic_string", "append", "fixed_length");
+    for (size_t i = 0; i < BENCH_OPS; i++) {
+        append_dynamic_string(str, "token,");
+    }
+    bench_end(&run, BENCH_OPS);
+    destroy_dynamic_string(str);
+
+    str = create_dynamic_string(0);
+    bench_begin(&run, "dynamic_string", "append_u64", "mixed_length");
+    for (size_t i = 0; i < BENCH_OPS; i++) {
+        dynamic_string_append_u64(str, values[i], 10);
+    }
+    bench_end(&run, BENCH_OPS);
+    size_t fast_length = str->length;
+    destroy_dynamic_string(str);
+
+    str = create_dynamic_string(0);
+    bench_begin(&run, "dynamic_string", "snprintf_append", "mixed_length");
+    for (size_t i = 0; i < BENCH_OPS; i++) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%llu", values[i]);
+        append_dynamic_string(str, buffer);
+    }
+    bench_end(&run, BENCH_OPS);
+    size_t slow_length = str->length;
+
+    // 在拼好的长串里找一个不存在的子串，测整串扫描
+    bench_begin(&run, "dynamic_string", "find_substring", "miss");
+    int found = find_substring(str, "x");
+    bench_end(&run, str->length);
+    destroy_dynamic_string(str);
+
+    fprintf(stderr, "dynamic_string: output length %s, find %d\n",
+            fast_length == slow_length ? "matches" : "differs", found);
+
+    free(values);
+
+    return 0;
 }
+#endif
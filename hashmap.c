@@ -11,17 +11,27 @@ typedef struct {
     size_t size;
     int (*match)(const void*, const void*);
     unsigned long (*hash)(const void*);
+    const allocator_t* allocator;
+#if defined(CONTAINER_STATS)
+    hashmap_stats stats;
+#endif
 } hashmap;
 
-hashmap* create_hashmap(int (*match)(const void*, const void*),
-                        unsigned long (*hash)(const void*))
+// hashmap 本身、槽位数组、条目以及键值的拷贝都从 allocator 分配，allocator 为 NULL 时使用 malloc
+hashmap* create_hashmap_with_allocator(int (*match)(const void*, const void*),
+                                       unsigned long (*hash)(const void*),
+                                       const allocator_t* allocator)
 {
-    hashmap* hm = malloc(sizeof(hashmap));
-    hm->entries = malloc(sizeof(hashmap_entry*) * HASHMAP_INITIAL_CAPACITY);
+    hashmap* hm = allocator_alloc(allocator, sizeof(hashmap));
+    hm->entries = allocator_alloc(allocator, sizeof(hashmap_entry*) * HASHMAP_INITIAL_CAPACITY);
     hm->capacity = HASHMAP_INITIAL_CAPACITY;
     hm->size = 0;
     hm->match = match;
     hm->hash = hash;
+    hm->allocator = allocator;
+#if defined(CONTAINER_STATS)
+    memset(&hm->stats, 0, sizeof(hm->stats));
+#endif
 
     for (size_t i = 0; i < hm->capacity; i++) {
         hm->entries[i] = NULL;
@@ -30,72 +40,409 @@ hashmap* create_hashmap(int (*match)(const void*, const void*),
     return hm;
 }
 
+hashmap* create_hashmap(int (*match)(const void*, const void*),
+                        unsigned long (*hash)(const void*))
+{
+    return create_hashmap_with_allocator(match, hash, NULL);
+}
+
 void destroy_hashmap(hashmap* hm)
 {
+    const allocator_t* allocator = hm->allocator;
+
     for (size_t i = 0; i < hm->capacity; i++) {
         hashmap_entry* entry = hm->entries[i];
         if (entry != NULL) {
-            free(entry->key);
-            free(entry->value);
-            free(entry);
+            allocator_free(allocator, entry->key);
+            allocator_free(allocator, entry->value);
+            allocator_free(allocator, entry);
         }
     }
 
-    free(hm->entries);
-    free(hm);
+    allocator_free(allocator, hm->entries);
+    allocator_free(allocator, hm);
 }
 
-void hashmap_put(hashmap* hm, const void* key, const void* value)
+// 扩容后按新容量重新放置所有条目，否则扩容前插入的键按新的下标会找不到
+void resize_hashmap(hashmap* hm, size_t new_capacity)
+{
+    hashmap_entry** old_entries = hm->entries;
+    size_t old_capacity = hm->capacity;
+#if defined(CONTAINER_STATS)
+    unsigned long long start = stats_now_ns();
+#endif
+
+    hm->entries = allocator_alloc(hm->allocator, sizeof(hashmap_entry*) * new_capacity);
+    memset(hm->entries, 0, sizeof(hashmap_entry*) * new_capacity);
+    hm->capacity = new_capacity;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        hashmap_entry* entry = old_entries[i];
+        if (entry == NULL) {
+            continue;
+        }
+        size_t index = hm->hash(entry->key) % new_capacity;
+        while (hm->entries[index] != NULL) {
+            index = (index + 1) % new_capacity;
+        }
+        hm->entries[index] = entry;
+    }
+
+    allocator_free(hm->allocator, old_entries);
+
+#if defined(CONTAINER_STATS)
+    unsigned long long elapsed = stats_now_ns() - start;
+    hm->stats.resizes++;
+    hm->stats.resize_ns += elapsed;
+    container_event_emit(&hm->stats.hook, CONTAINER_EVENT_HASHMAP_RESIZE, hm, old_capacity, new_capacity, elapsed);
+#endif
+}
+
+// 返回键所在的条目，条目在扩容和删除其他键时地址不变
+hashmap_entry* hashmap_put_entry(hashmap* hm, const void* key, const void* value)
 {
     unsigned long hash = hm->hash(key);
     size_t index = hash % hm->capacity;
+#if defined(CONTAINER_STATS)
+    size_t home = index;
+    hm->stats.puts++;
+#endif
 
     hashmap_entry* entry = hm->entries[index];
     while (entry != NULL) {
         if (hm->match(entry->key, key)) {
-            free(entry->value);
-            entry->value = malloc(sizeof(value));
+#if defined(CONTAINER_STATS)
+            hashmap_stats_record_probe(&hm->stats, (index + hm->capacity - home) % hm->capacity);
+#endif
+            allocator_free(hm->allocator, entry->value);
+            entry->value = allocator_alloc(hm->allocator, sizeof(value));
             memcpy(entry->value, value, sizeof(value));
-            return;
+            return entry;
         }
         index = (index + 1) % hm->capacity;
         entry = hm->entries[index];
     }
 
-    entry = malloc(sizeof(hashmap_entry));
-    entry->key = malloc(sizeof(key));
+#if defined(CONTAINER_STATS)
+    hashmap_stats_record_probe(&hm->stats, (index + hm->capacity - home) % hm->capacity);
+#endif
+
+    entry = allocator_alloc(hm->allocator, sizeof(hashmap_entry));
+    entry->key = allocator_alloc(hm->allocator, sizeof(key));
     memcpy(entry->key, key, sizeof(key));
-    entry->value = malloc(sizeof(value));
+    entry->value = allocator_alloc(hm->allocator, sizeof(value));
     memcpy(entry->value, value, sizeof(value));
 
     hm->entries[index] = entry;
     hm->size++;
 
     if (hm->size >= hm->capacity / 2) {
-        size_t new_capacity = hm->capacity * 2;
-        hm->entries = realloc(hm->entries, sizeof(hashmap_entry*) * new_capacity);
-        memset(hm->entries + hm->capacity, 0, sizeof(hashmap_entry*) * (new_capacity - hm->capacity));
-        hm->capacity = new_capacity;
+        resize_hashmap(hm, hm->capacity * 2);
     }
+    return entry;
+}
+
+void hashmap_put(hashmap* hm, const void* key, const void* value)
+{
+    hashmap_put_entry(hm, key, value);
 }
 
 void* hashmap_get(hashmap* hm, const void* key)
 {
     unsigned long hash = hm->hash(key);
     size_t index = hash % hm->capacity;
+#if defined(CONTAINER_STATS)
+    size_t home = index;
+    hm->stats.gets++;
+#endif
 
     hashmap_entry* entry = hm->entries[index];
     while (entry != NULL) {
         if (hm->match(entry->key, key)) {
+#if defined(CONTAINER_STATS)
+            hashmap_stats_record_probe(&hm->stats, (index + hm->capacity - home) % hm->capacity);
+#endif
             return entry->value;
         }
         index = (index + 1) % hm->capacity;
         entry = hm->entries[index];
     }
 
+#if defined(CONTAINER_STATS)
+    hashmap_stats_record_probe(&hm->stats, (index + hm->capacity - home) % hm->capacity);
+#endif
+
     return NULL; // Key not found
 }
 
+// 删除后把同一探测链上后面的条目前移填补空位，不留墓碑，查找长度不会因删除而变长。
+// 键不存在时返回 0
+int hashmap_remove(hashmap* hm, const void* key)
+{
+    size_t index = hm->hash(key) % hm->capacity;
+    hashmap_entry* entry = hm->entries[index];
+    while (entry != NULL && !hm->match(entry->key, key)) {
+        index = (index + 1) % hm->capacity;
+        entry = hm->entries[index];
+    }
+    if (entry == NULL) {
+        return 0;
+    }
+
+    allocator_free(hm->allocator, entry->key);
+    allocator_free(hm->allocator, entry->value);
+    allocator_free(hm->allocator, entry);
+    hm->size--;
+
+    size_t hole = index;
+    size_t next = (hole + 1) % hm->capacity;
+    while (hm->entries[next] != NULL) {
+        size_t home = hm->hash(hm->entries[next]->key) % hm->capacity;
+        // 只有从起始位置到空位的距离不超过到当前位置的距离时，前移后仍能被找到
+        if ((next + hm->capacity - home) % hm->capacity >= (next + hm->capacity - hole) % hm->capacity) {
+            hm->entries[hole] = hm->entries[next];
+            hole = next;
+        }
+        next = (next + 1) % hm->capacity;
+    }
+    hm->entries[hole] = NULL;
+    return 1;
+}
+
+// 基于 hashmap 的有界 LRU 缓存。hashmap 的值是节点指针，节点通过侵入式双向链表
+// 按最近使用顺序串起来，get/put/touch/evict 都是 O(1)。
+// 键按 hashmap 的规则拷贝 sizeof(void*) 字节（见 create_lru_cache_with_allocator）；
+// 值只保存指针，由调用方在淘汰回调里释放。
+typedef struct lru_node {
+    struct lru_node* prev;
+    struct lru_node* next;
+    const void* key;    // 指向 hashmap 条目里的键拷贝
+    void* value;
+    size_t charge;
+} lru_node_t;
+
+// 条目离开缓存（淘汰、被覆盖、删除、销毁缓存）时调用
+typedef void (*lru_evict_callback)(const void* key, void* value, void* context);
+
+typedef struct {
+    hashmap* map;
+    lru_node_t head;        // 哨兵，head.next 最近使用，head.prev 最久未使用
+    size_t size;
+    size_t max_entries;     // 0 表示不限制条目数
+    size_t charge;
+    size_t max_charge;      // 0 表示不限制总 charge（例如字节数）
+    lru_evict_callback on_evict;
+    void* evict_context;
+    const allocator_t* allocator;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} lru_cache;
+
+// 键必须正好是 sizeof(void*) 字节（例如 64 位整数或哈希值）：和 hashmap 一样，put 时只拷贝这么多字节，
+// match/hash 收到的是这份拷贝。字符串或结构体键要传指向键指针的指针（key 为 const char**），
+// match/hash 解引用后再比较，键本身的内存由调用方保证在条目存活期间有效。
+// 缓存、节点和内部的 hashmap 都从 allocator 分配，allocator 为 NULL 时使用 malloc
+lru_cache* create_lru_cache_with_allocator(int (*match)(const void*, const void*),
+                                           unsigned long (*hash)(const void*),
+                                           size_t max_entries, size_t max_charge,
+                                           const allocator_t* allocator)
+{
+    lru_cache* cache = allocator_alloc(allocator, sizeof(lru_cache));
+    cache->map = create_hashmap_with_allocator(match, hash, allocator);
+    cache->head.prev = &cache->head;
+    cache->head.next = &cache->head;
+    cache->size = 0;
+    cache->max_entries = max_entries;
+    cache->charge = 0;
+    cache->max_charge = max_charge;
+    cache->on_evict = NULL;
+    cache->evict_context = NULL;
+    cache->allocator = allocator;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    return cache;
+}
+
+lru_cache* create_lru_cache(int (*match)(const void*, const void*),
+                            unsigned long (*hash)(const void*),
+                            size_t max_entries, size_t max_charge)
+{
+    return create_lru_cache_with_allocator(match, hash, max_entries, max_charge, NULL);
+}
+
+void lru_cache_set_evict_callback(lru_cache* cache, lru_evict_callback callback, void* context)
+{
+    cache->on_evict = callback;
+    cache->evict_context = context;
+}
+
+void lru_unlink(lru_node_t* node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+}
+
+void lru_link_front(lru_cache* cache, lru_node_t* node)
+{
+    node->prev = &cache->head;
+    node->next = cache->head.next;
+    cache->head.next->prev = node;
+    cache->head.next = node;
+}
+
+lru_node_t* lru_find(lru_cache* cache, const void* key)
+{
+    lru_node_t** slot = hashmap_get(cache->map, key);
+    return slot != NULL ? *slot : NULL;
+}
+
+// 回调之后再从 hashmap 删除，回调拿到的键此时仍然有效
+void lru_drop(lru_cache* cache, lru_node_t* node)
+{
+    if (cache->on_evict != NULL) {
+        cache->on_evict(node->key, node->value, cache->evict_context);
+    }
+    lru_unlink(node);
+    cache->size--;
+    cache->charge -= node->charge;
+    hashmap_remove(cache->map, node->key);
+    allocator_free(cache->allocator, node);
+}
+
+// 淘汰最久未使用的条目，缓存为空时返回 0
+int lru_cache_evict(lru_cache* cache)
+{
+    if (cache->size == 0) {
+        return 0;
+    }
+    lru_drop(cache, cache->head.prev);
+    cache->evictions++;
+    return 1;
+}
+
+// 超出预算时从尾部淘汰，但总会保留最近使用的一个条目，
+// 否则 charge 超过 max_charge 的单个条目刚放进去就会被淘汰
+void lru_enforce_budget(lru_cache* cache)
+{
+    while (cache->size > 1 &&
+           ((cache->max_entries != 0 && cache->size > cache->max_entries) ||
+            (cache->max_charge != 0 && cache->charge > cache->max_charge))) {
+        lru_cache_evict(cache);
+    }
+}
+
+// 命中时把条目移到最前面，未命中返回 NULL
+void* lru_cache_get(lru_cache* cache, const void* key)
+{
+    lru_node_t* node = lru_find(cache, key);
+    if (node == NULL) {
+        cache->misses++;
+        return NULL;
+    }
+    cache->hits++;
+    if (cache->head.next != node) {
+        lru_unlink(node);
+        lru_link_front(cache, node);
+    }
+    return node->value;
+}
+
+// 只查看，不改变最近使用顺序，也不计入命中统计
+void* lru_cache_peek(lru_cache* cache, const void* key)
+{
+    lru_node_t* node = lru_find(cache, key);
+    return node != NULL ? node->value : NULL;
+}
+
+// 把条目标记为最近使用，键不存在时返回 0
+int lru_cache_touch(lru_cache* cache, const void* key)
+{
+    lru_node_t* node = lru_find(cache, key);
+    if (node == NULL) {
+        return 0;
+    }
+    lru_unlink(node);
+    lru_link_front(cache, node);
+    return 1;
+}
+
+// charge 是条目占用的预算（例如字节数），只按条目数限制时传 1。
+// 键已存在时旧值交给淘汰回调，新值放到最前面
+void lru_cache_put(lru_cache* cache, const void* key, void* value, size_t charge)
+{
+    lru_node_t* node = lru_find(cache, key);
+    if (node != NULL) {
+        if (cache->on_evict != NULL && node->value != value) {
+            cache->on_evict(node->key, node->value, cache->evict_context);
+        }
+        lru_unlink(node);
+        cache->charge -= node->charge;
+    } else {
+        node = allocator_alloc(cache->allocator, sizeof(lru_node_t));
+        node->key = hashmap_put_entry(cache->map, key, &node)->key;
+        cache->size++;
+    }
+
+    node->value = value;
+    node->charge = charge;
+    cache->charge += charge;
+    lru_link_front(cache, node);
+    lru_enforce_budget(cache);
+}
+
+// 删除条目并调用淘汰回调，键不存在时返回 0
+int lru_cache_remove(lru_cache* cache, const void* key)
+{
+    lru_node_t* node = lru_find(cache, key);
+    if (node == NULL) {
+        return 0;
+    }
+    lru_drop(cache, node);
+    return 1;
+}
+
+// 剩余的条目都会交给淘汰回调
+void destroy_lru_cache(lru_cache* cache)
+{
+    while (cache->size > 0) {
+        lru_drop(cache, cache->head.prev);
+    }
+    destroy_hashmap(cache->map);
+    allocator_free(cache->allocator, cache);
+}
+
+#if defined(CONTAINER_STATS)
+// 每次扩容后回调 callback，可用于把扩容耗时送进监控
+void hashmap_set_event_callback(hashmap* hm, container_event_callback callback, void* context)
+{
+    hm->stats.hook.callback = callback;
+    hm->stats.hook.context = context;
+}
+
+const hashmap_stats* hashmap_get_stats(const hashmap* hm)
+{
+    return &hm->stats;
+}
+
+void hashmap_stats_dump(const hashmap* hm, FILE* out)
+{
+    const hashmap_stats* stats = &hm->stats;
+    size_t lookups = stats->puts + stats->gets;
+
+    fprintf(out, "{\"container\":\"hashmap\",\"size\":%zu,\"capacity\":%zu,\"puts\":%zu,\"gets\":%zu,"
+                 "\"avg_probe\":%.3f,\"max_probe\":%zu,\"resizes\":%zu,\"resize_ns\":%llu,\"probe_histogram\":[",
+            hm->size, hm->capacity, stats->puts, stats->gets,
+            lookups ? (double)stats->total_probes / lookups : 0.0, stats->max_probe,
+            stats->resizes, stats->resize_ns);
+    for (size_t i = 0; i < STATS_PROBE_BUCKETS; i++) {
+        fprintf(out, i ? ",%zu" : "%zu", stats->probe_histogram[i]);
+    }
+    fprintf(out, "]}\n");
+}
+#endif
+
 #if defined(TEST)
 // 自定义匹配函数示例：比较两个整数是否相等
 int int_match(const void* key1, const void* key2)
@@ -109,6 +456,23 @@ unsigned long int_hash(const void* key)
     return *(int*)key;
 }
 
+// hashmap 按指针大小拷贝键，缓存示例用 8 字节的键
+int long_long_match(const void* key1, const void* key2)
+{
+    return *(const long long*)key1 == *(const long long*)key2;
+}
+
+unsigned long long_long_hash(const void* key)
+{
+    return (unsigned long)*(const long long*)key;
+}
+
+void print_evicted(const void* key, void* value, void* context)
+{
+    (void)context;
+    printf("evicted %lld: %s\n", *(const long long*)key, (const char*)value);
+}
+
 int main()
 {
     hashmap* hm = create_hashmap(int_match, int_hash);
@@ -123,16 +487,119 @@ int main()
 
     int* retrieved_value1 = hashmap_get(hm, &key1);
     if (retrieved_value1 != NULL) {
-        printf(“Value for key1: %d\n“, *retrieved_value1);
+        printf("Value for key1: %d\n", *retrieved_value1);
     }
 
     int* retrieved_value2 = hashmap_get(hm, &key2);
     if (retrieved_value2 != NULL) {
-        printf(“Value for key2: %d\n“, *retrieved_value2);
+        printf("Value for key2: %d\n", *retrieved_value2);
     }
 
     destroy_hashmap(hm);
 
+    // 插入超过初始容量的键，扩容前插入的键在重新放置后仍然能找到
+    long long numbers[100];
+    hm = create_hashmap(long_long_match, long_long_hash);
+    for (int i = 0; i < 100; i++) {
+        numbers[i] = i * 7;
+        hashmap_put(hm, &numbers[i], &numbers[i]);
+    }
+    int found = 0;
+    for (int i = 0; i < 100; i++) {
+        long long* value = hashmap_get(hm, &numbers[i]);
+        found += value != NULL && *value == numbers[i];
+    }
+    printf("found %d of 100 after growing to %zu slots\n", found, hm->capacity);
+    destroy_hashmap(hm);
+
+    // 容量为 2 的 LRU 缓存，访问过的键不会先被淘汰
+    long long keys[3] = {1, 2, 3};
+    lru_cache* cache = create_lru_cache(long_long_match, long_long_hash, 2, 0);
+    lru_cache_set_evict_callback(cache, print_evicted, NULL);
+    lru_cache_put(cache, &keys[0], "one", 1);
+    lru_cache_put(cache, &keys[1], "two", 1);
+    lru_cache_get(cache, &keys[0]);
+    lru_cache_put(cache, &keys[2], "three", 1);
+    printf("key 2 cached: %d, key 1 cached: %d\n",
+           lru_cache_peek(cache, &keys[1]) != NULL, lru_cache_peek(cache, &keys[0]) != NULL);
+    destroy_lru_cache(cache);
+
+    return 0;
+}
+#endif
+
+#if defined(BENCH)
+#define BENCH_LRU_ENTRIES (BENCH_OPS / 8)
+
+int u64_match(const void* key1, const void* key2)
+{
+    return *(const unsigned long long*)key1 == *(const unsigned long long*)key2;
+}
+
+unsigned long u64_hash(const void* key)
+{
+    return (unsigned long)bench_scramble(*(const unsigned long long*)key);
+}
+
+int main()
+{
+    for (int dist = 0; dist < BENCH_DIST_COUNT; dist++) {
+        unsigned long long* keys = bench_keys((bench_dist)dist, BENCH_OPS, BENCH_OPS, 1);
+        unsigned long long* lookups = bench_keys((bench_dist)dist, BENCH_OPS, BENCH_OPS, 2);
+        hashmap* hm = create_hashmap(u64_match, u64_hash);
+        bench_run run;
+
+        bench_begin(&run, "hashmap", "put", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            hashmap_put(hm, &keys[i], &keys[i]);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        // 键是 8 字节整数，和 hashmap 复制的指针大小一致
+        size_t hits = 0;
+        bench_begin(&run, "hashmap", "get", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            hits += hashmap_get(hm, &lookups[i]) != NULL;
+        }
+        bench_end(&run, BENCH_OPS);
+        fprintf(stderr, "hashmap %s: size %zu, get hit rate %.3f\n",
+                bench_dist_names[dist], hm->size, (double)hits / BENCH_OPS);
+#if defined(CONTAINER_STATS)
+        hashmap_stats_dump(hm, stderr);
+#endif
+
+        destroy_hashmap(hm);
+
+        // 缓存容纳 1/8 的键空间：先 get，未命中再 put，再单独测只走命中路径的 get
+        lru_cache* cache = create_lru_cache(u64_match, u64_hash, BENCH_LRU_ENTRIES, 0);
+        bench_begin(&run, "lru_cache", "get_or_put", bench_dist_names[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            if (lru_cache_get(cache, &lookups[i]) == NULL) {
+                lru_cache_put(cache, &lookups[i], &lookups[i], 1);
+            }
+        }
+        bench_end(&run, BENCH_OPS);
+
+        size_t hit_count = 0;
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            if (lru_cache_peek(cache, &keys[i]) != NULL) {
+                keys[hit_count++] = keys[i];
+            }
+        }
+        bench_begin(&run, "lru_cache", "get_hit", bench_dist_names[dist]);
+        for (size_t i = 0; i < hit_count; i++) {
+            lru_cache_get(cache, &keys[i]);
+        }
+        bench_end(&run, hit_count);
+        fprintf(stderr, "lru_cache %s: size %zu, get_or_put hit rate %.3f, evictions %zu\n",
+                bench_dist_names[dist], cache->size, (double)(cache->hits - hit_count) / BENCH_OPS,
+                cache->evictions);
+
+        destroy_lru_cache(cache);
+        free(lookups);
+        free(keys);
+    }
+
     return 0;
 }
 #endif
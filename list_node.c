@@ -3,33 +3,238 @@ typedef struct list_node {
     struct list_node* next;
 } list_node_t;
 
+#define UNROLLED_NODE_DEFAULT_CAPACITY 32
+
+// 展开链表节点：每个节点连续存放多个 data 指针
+typedef struct unrolled_node {
+    struct unrolled_node* prev;
+    struct unrolled_node* next;
+    size_t count;
+    void* data[];
+} unrolled_node_t;
+
 typedef struct {
     list_node_t* head;
     list_node_t* tail;
     size_t size;
+    // 以下字段仅在展开模式下使用，node_capacity 为 0 表示普通单链表
+    size_t node_capacity;
+    unrolled_node_t* chunk_head;
+    unrolled_node_t* chunk_tail;
+    // 最近一次定位到的节点及其首元素下标，顺序按下标访问时可以从这里继续
+    unrolled_node_t* cursor;
+    size_t cursor_base;
+    const allocator_t* allocator;
 } linked_list_t;
 
-linked_list_t* create_linked_list() {
-    linked_list_t* list = malloc(sizeof(linked_list_t));
+// 链表和节点从 allocator 分配，allocator 为 NULL 时使用 malloc。
+// 链表销毁或删除元素时会用同一个 allocator 释放 data，所以 data 也应从它分配。
+linked_list_t* create_linked_list_with_allocator(const allocator_t* allocator) {
+    linked_list_t* list = allocator_alloc(allocator, sizeof(linked_list_t));
     list->head = NULL;
     list->tail = NULL;
     list->size = 0;
+    list->node_capacity = 0;
+    list->chunk_head = NULL;
+    list->chunk_tail = NULL;
+    list->cursor = NULL;
+    list->cursor_base = 0;
+    list->allocator = allocator;
+    return list;
+}
+
+linked_list_t* create_linked_list() {
+    return create_linked_list_with_allocator(NULL);
+}
+
+// 创建展开链表，接口与普通链表相同。
+// 按下标访问的代价约为 size / node_capacity + node_capacity，
+// node_capacity 取 sqrt(size) 左右时为 O(sqrt(n))；
+// 小于 2 时（包括 0 和 1）使用默认值 UNROLLED_NODE_DEFAULT_CAPACITY。
+linked_list_t* create_unrolled_linked_list_with_allocator(size_t node_capacity, const allocator_t* allocator) {
+    linked_list_t* list = create_linked_list_with_allocator(allocator);
+    list->node_capacity = node_capacity < 2 ? UNROLLED_NODE_DEFAULT_CAPACITY : node_capacity;
     return list;
 }
 
+linked_list_t* create_unrolled_linked_list(size_t node_capacity) {
+    return create_unrolled_linked_list_with_allocator(node_capacity, NULL);
+}
+
+unrolled_node_t* create_unrolled_node(linked_list_t* list) {
+    unrolled_node_t* node = allocator_alloc(list->allocator,
+                                            sizeof(unrolled_node_t) + list->node_capacity * sizeof(void*));
+    node->prev = NULL;
+    node->next = NULL;
+    node->count = 0;
+    return node;
+}
+
+void unlink_unrolled_node(linked_list_t* list, unrolled_node_t* node) {
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        list->chunk_head = node->next;
+    }
+
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    } else {
+        list->chunk_tail = node->prev;
+    }
+
+    allocator_free(list->allocator, node);
+}
+
+// 定位第 index 个元素所在的节点，*offset 返回节点内偏移
+unrolled_node_t* unrolled_locate(linked_list_t* list, size_t index, size_t* offset) {
+    unrolled_node_t* current = list->chunk_head;
+    size_t base = 0;
+
+    if (list->cursor != NULL && list->cursor_base <= index) {
+        current = list->cursor;
+        base = list->cursor_base;
+    }
+
+    while (index - base >= current->count) {
+        base += current->count;
+        current = current->next;
+    }
+
+    list->cursor = current;
+    list->cursor_base = base;
+    *offset = index - base;
+    return current;
+}
+
+void destroy_unrolled_linked_list(linked_list_t* list) {
+    unrolled_node_t* current = list->chunk_head;
+    while (current != NULL) {
+        unrolled_node_t* next = current->next;
+        for (size_t i = 0; i < current->count; i++) {
+            allocator_free(list->allocator, current->data[i]);
+        }
+        allocator_free(list->allocator, current);
+        current = next;
+    }
+    allocator_free(list->allocator, list);
+}
+
+void unrolled_linked_list_add(linked_list_t* list, void* data) {
+    unrolled_node_t* tail = list->chunk_tail;
+
+    if (tail == NULL || tail->count == list->node_capacity) {
+        unrolled_node_t* new_node = create_unrolled_node(list);
+        new_node->prev = tail;
+        if (tail != NULL) {
+            tail->next = new_node;
+        } else {
+            list->chunk_head = new_node;
+        }
+        list->chunk_tail = new_node;
+        tail = new_node;
+    }
+
+    tail->data[tail->count++] = data;
+    list->size++;
+}
+
+void unrolled_linked_list_remove(linked_list_t* list, size_t index) {
+    size_t offset;
+    unrolled_node_t* current = unrolled_locate(list, index, &offset);
+
+    allocator_free(list->allocator, current->data[offset]);
+    memmove(&current->data[offset], &current->data[offset + 1],
+            (current->count - offset - 1) * sizeof(void*));
+    current->count--;
+    list->size--;
+
+    if (current->count == 0) {
+        // 后继节点的首元素下标正好是被删除节点原来的下标
+        list->cursor = current->next;
+        unlink_unrolled_node(list, current);
+        return;
+    }
+
+    // 节点不足半满时与后继合并，避免节点越删越稀疏
+    unrolled_node_t* next = current->next;
+    if (next != NULL && current->count < list->node_capacity / 2 &&
+        current->count + next->count <= list->node_capacity) {
+        memcpy(&current->data[current->count], next->data, next->count * sizeof(void*));
+        current->count += next->count;
+        unlink_unrolled_node(list, next);
+    }
+}
+
+void unrolled_linked_list_insert_after(linked_list_t* list, size_t index, void* data) {
+    size_t offset;
+    unrolled_node_t* current = unrolled_locate(list, index, &offset);
+    offset++;
+
+    if (current->count == list->node_capacity) {
+        // 节点已满，把后一半搬到新节点
+        unrolled_node_t* new_node = create_unrolled_node(list);
+        size_t half = current->count / 2;
+
+        new_node->count = current->count - half;
+        memcpy(new_node->data, &current->data[half], new_node->count * sizeof(void*));
+        current->count = half;
+
+        new_node->prev = current;
+        new_node->next = current->next;
+        if (current->next != NULL) {
+            current->next->prev = new_node;
+        } else {
+            list->chunk_tail = new_node;
+        }
+        current->next = new_node;
+
+        if (offset > half) {
+            list->cursor_base += half;
+            list->cursor = new_node;
+            offset -= half;
+            current = new_node;
+        }
+    }
+
+    memmove(&current->data[offset + 1], &current->data[offset],
+            (current->count - offset) * sizeof(void*));
+    current->data[offset] = data;
+    current->count++;
+    list->size++;
+}
+
+void unrolled_linked_list_traverse(linked_list_t* list, void (*callback)(void*)) {
+    for (unrolled_node_t* current = list->chunk_head; current != NULL; current = current->next) {
+        for (size_t i = 0; i < current->count; i++) {
+            callback(current->data[i]);
+        }
+    }
+}
+
 void destroy_linked_list(linked_list_t* list) {
+    if (list->node_capacity != 0) {
+        destroy_unrolled_linked_list(list);
+        return;
+    }
+
     list_node_t* current = list->head;
     while (current != NULL) {
         list_node_t* next = current->next;
-        free(current->data);
-        free(current);
+        allocator_free(list->allocator, current->data);
+        allocator_free(list->allocator, current);
         current = next;
     }
-    free(list);
+    allocator_free(list->allocator, list);
 }
 
 void linked_list_add(linked_list_t* list, void* data) {
-    list_node_t* new_node = malloc(sizeof(list_node_t));
+    if (list->node_capacity != 0) {
+        unrolled_linked_list_add(list, data);
+        return;
+    }
+
+    list_node_t* new_node = allocator_alloc(list->allocator, sizeof(list_node_t));
     new_node->data = data;
     new_node->next = NULL;
 
@@ -49,6 +254,12 @@ void* linked_list_get(linked_list_t* list, size_t index) {
         return NULL;
     }
 
+    if (list->node_capacity != 0) {
+        size_t offset;
+        unrolled_node_t* node = unrolled_locate(list, index, &offset);
+        return node->data[offset];
+    }
+
     list_node_t* current = list->head;
     for (size_t i = 0; i < index; i++) {
         current = current->next;
@@ -62,6 +273,11 @@ void linked_list_remove(linked_list_t* list, size_t index) {
         return;
     }
 
+    if (list->node_capacity != 0) {
+        unrolled_linked_list_remove(list, index);
+        return;
+    }
+
     list_node_t* current = list->head;
     list_node_t* previous = NULL;
 
@@ -80,8 +296,8 @@ void linked_list_remove(linked_list_t* list, size_t index) {
         list->tail = previous;
     }
 
-    free(current->data);
-    free(current);
+    allocator_free(list->allocator, current->data);
+    allocator_free(list->allocator, current);
     list->size--;
 }
 
@@ -90,13 +306,18 @@ void linked_list_insert_after(linked_list_t* list, size_t index, void* data) {
         return;
     }
 
+    if (list->node_capacity != 0) {
+        unrolled_linked_list_insert_after(list, index, data);
+        return;
+    }
+
     list_node_t* current = list->head;
 
     for (size_t i = 0; i < index; i++) {
         current = current->next;
     }
 
-    list_node_t* new_node = malloc(sizeof(list_node_t));
+    list_node_t* new_node = allocator_alloc(list->allocator, sizeof(list_node_t));
     new_node->data = data;
     new_node->next = current->next;
 
@@ -110,6 +331,11 @@ void linked_list_insert_after(linked_list_t* list, size_t index, void* data) {
 }
 
 void linked_list_traverse(linked_list_t* list, void (*callback)(void*)) {
+    if (list->node_capacity != 0) {
+        unrolled_linked_list_traverse(list, callback);
+        return;
+    }
+
     list_node_t* current = list->head;
     while (current != NULL) {
         callback(current->data);
@@ -151,7 +377,90 @@ int main() {
 
     destroy_linked_list(list);
 
+    // 展开链表：接口相同，按下标访问不再逐个节点遍历
+    linked_list_t* unrolled = create_unrolled_linked_list(4);
+    for (int i = 0; i < 10; i++) {
+        int* value = malloc(sizeof(int));
+        *value = i;
+        linked_list_add(unrolled, value);
+    }
+
+    linked_list_remove(unrolled, 3);
+
+    int* data5 = malloc(sizeof(int));
+    *data5 = 100;
+    linked_list_insert_after(unrolled, 5, data5);
+
+    for (size_t i = 0; i < unrolled->size; i++) {
+        printf("%d ", *(int*)linked_list_get(unrolled, i));
+    }
+    printf("\n");
+
+    destroy_linked_list(unrolled);
+
     return 0;
 }
 #endif
 
+
+#if defined(BENCH)
+#define BENCH_LIST_SIZE (BENCH_OPS / 16)
+#define BENCH_LIST_POSITIONAL_OPS 4096
+
+unsigned long long traverse_sum = 0;
+
+void sum_int(void* data) {
+    traverse_sum += *(int*)data;
+}
+
+int main() {
+    const char* kinds[2] = {"linked_list", "unrolled_linked_list"};
+    bench_run run;
+
+    for (int unrolled = 0; unrolled < 2; unrolled++) {
+        for (int dist = 0; dist < BENCH_DIST_COUNT; dist++) {
+            unsigned long long* positions =
+                bench_keys((bench_dist)dist, BENCH_LIST_POSITIONAL_OPS, BENCH_LIST_SIZE / 2, 1);
+            linked_list_t* list = unrolled ? create_unrolled_linked_list(0) : create_linked_list();
+
+            bench_begin(&run, kinds[unrolled], "add", bench_dist_names[dist]);
+            for (int i = 0; i < BENCH_LIST_SIZE; i++) {
+                int* data = malloc(sizeof(int));
+                *data = i;
+                linked_list_add(list, data);
+            }
+            bench_end(&run, BENCH_LIST_SIZE);
+
+            bench_begin(&run, kinds[unrolled], "get", bench_dist_names[dist]);
+            for (int i = 0; i < BENCH_LIST_POSITIONAL_OPS; i++) {
+                traverse_sum += *(int*)linked_list_get(list, positions[i]);
+            }
+            bench_end(&run, BENCH_LIST_POSITIONAL_OPS);
+
+            bench_begin(&run, kinds[unrolled], "insert_after", bench_dist_names[dist]);
+            for (int i = 0; i < BENCH_LIST_POSITIONAL_OPS; i++) {
+                int* data = malloc(sizeof(int));
+                *data = i;
+                linked_list_insert_after(list, positions[i], data);
+            }
+            bench_end(&run, BENCH_LIST_POSITIONAL_OPS);
+
+            bench_begin(&run, kinds[unrolled], "remove", bench_dist_names[dist]);
+            for (int i = 0; i < BENCH_LIST_POSITIONAL_OPS; i++) {
+                linked_list_remove(list, positions[i]);
+            }
+            bench_end(&run, BENCH_LIST_POSITIONAL_OPS);
+
+            bench_begin(&run, kinds[unrolled], "traverse", bench_dist_names[dist]);
+            linked_list_traverse(list, sum_int);
+            bench_end(&run, list->size);
+
+            destroy_linked_list(list);
+            free(positions);
+        }
+    }
+    fprintf(stderr, "linked_list: checksum %llu\n", traverse_sum);
+
+    return 0;
+}
+#endif
@@ -0,0 +1,402 @@
+#include <stdatomic.h>
+
+#define CACHE_LINE_SIZE 64
+
+// 与 list_node_t 布局相同的侵入式节点，next 为原子指针
+typedef struct mpsc_node {
+    void* data;
+    _Atomic(struct mpsc_node*) next;
+} mpsc_node_t;
+
+// Vyukov 无锁多生产者单消费者队列。
+// 生产者只对 head 做一次原子交换，消费者独占 tail，节点内存由调用方管理。
+typedef struct {
+    _Atomic(mpsc_node_t*) head;
+    char pad0[CACHE_LINE_SIZE - sizeof(mpsc_node_t*)];
+    mpsc_node_t* tail;
+    mpsc_node_t stub;
+    const allocator_t* allocator;
+    char pad1[CACHE_LINE_SIZE - sizeof(mpsc_node_t*) - sizeof(mpsc_node_t) - sizeof(allocator_t*)];
+} mpsc_queue_t;
+
+// 只有队列结构本身从 allocator 分配，allocator 为 NULL 时使用 malloc
+mpsc_queue_t* create_mpsc_queue_with_allocator(const allocator_t* allocator) {
+    mpsc_queue_t* queue = allocator_alloc(allocator, sizeof(mpsc_queue_t));
+    queue->allocator = allocator;
+    queue->stub.data = NULL;
+    atomic_init(&queue->stub.next, NULL);
+    atomic_init(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+    return queue;
+}
+
+mpsc_queue_t* create_mpsc_queue() {
+    return create_mpsc_queue_with_allocator(NULL);
+}
+
+void destroy_mpsc_queue(mpsc_queue_t* queue) {
+    allocator_free(queue->allocator, queue);
+}
+
+// 入队一条由 next 串好的节点链 first..last，无论链多长都只有一次原子交换
+void mpsc_queue_push_batch(mpsc_queue_t* queue, mpsc_node_t* first, mpsc_node_t* last) {
+    atomic_store_explicit(&last->next, NULL, memory_order_relaxed);
+    mpsc_node_t* prev = atomic_exchange_explicit(&queue->head, last, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, first, memory_order_release);
+}
+
+void mpsc_queue_push(mpsc_queue_t* queue, mpsc_node_t* node) {
+    mpsc_queue_push_batch(queue, node, node);
+}
+
+// 只能由消费者线程调用。队列为空，或生产者尚未完成链接时返回 NULL
+mpsc_node_t* mpsc_queue_pop(mpsc_queue_t* queue) {
+    mpsc_node_t* tail = queue->tail;
+    mpsc_node_t* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &queue->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+
+    if (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) {
+        return NULL;
+    }
+
+    // tail 是最后一个节点，重新挂上 stub 才能把它取走
+    mpsc_queue_push(queue, &queue->stub);
+
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+size_t mpsc_queue_pop_batch(mpsc_queue_t* queue, mpsc_node_t** nodes, size_t max_count) {
+    size_t count = 0;
+    while (count < max_count) {
+        mpsc_node_t* node = mpsc_queue_pop(queue);
+        if (node == NULL) {
+            break;
+        }
+        nodes[count++] = node;
+    }
+    return count;
+}
+
+typedef struct {
+    _Atomic size_t sequence;
+    void* data;
+} mpmc_cell_t;
+
+// Vyukov 有界多生产者多消费者环形队列，容量必须是 2 的幂
+typedef struct {
+    mpmc_cell_t* cells;
+    size_t mask;
+    const allocator_t* allocator;
+    char pad0[CACHE_LINE_SIZE - sizeof(mpmc_cell_t*) - sizeof(size_t) - sizeof(allocator_t*)];
+    _Atomic size_t enqueue_pos;
+    char pad1[CACHE_LINE_SIZE - sizeof(size_t)];
+    _Atomic size_t dequeue_pos;
+    char pad2[CACHE_LINE_SIZE - sizeof(size_t)];
+} mpmc_ring_t;
+
+// 环形队列和槽位数组从 allocator 分配，allocator 为 NULL 时使用 malloc
+mpmc_ring_t* create_mpmc_ring_with_allocator(size_t capacity, const allocator_t* allocator) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return NULL;
+    }
+
+    mpmc_ring_t* ring = allocator_alloc(allocator, sizeof(mpmc_ring_t));
+    ring->cells = allocator_alloc(allocator, sizeof(mpmc_cell_t) * capacity);
+    ring->mask = capacity - 1;
+    ring->allocator = allocator;
+
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&ring->cells[i].sequence, i);
+        ring->cells[i].data = NULL;
+    }
+
+    atomic_init(&ring->enqueue_pos, 0);
+    atomic_init(&ring->dequeue_pos, 0);
+    return ring;
+}
+
+mpmc_ring_t* create_mpmc_ring(size_t capacity) {
+    return create_mpmc_ring_with_allocator(capacity, NULL);
+}
+
+void destroy_mpmc_ring(mpmc_ring_t* ring) {
+    allocator_free(ring->allocator, ring->cells);
+    allocator_free(ring->allocator, ring);
+}
+
+// 一次 CAS 认领一段连续的空槽位，返回实际写入的个数（队列满时为 0）
+size_t mpmc_ring_push_batch(mpmc_ring_t* ring, void* const* items, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        size_t ready = 0;
+        while (ready < count) {
+            mpmc_cell_t* cell = &ring->cells[(pos + ready) & ring->mask];
+            size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+            if (seq != pos + ready) {
+                break;
+            }
+            ready++;
+        }
+
+        if (ready == 0) {
+            mpmc_cell_t* cell = &ring->cells[pos & ring->mask];
+            size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+            if ((ptrdiff_t)(seq - pos) < 0) {
+                return 0;
+            }
+            pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + ready,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            for (size_t i = 0; i < ready; i++) {
+                mpmc_cell_t* cell = &ring->cells[(pos + i) & ring->mask];
+                cell->data = items[i];
+                atomic_store_explicit(&cell->sequence, pos + i + 1, memory_order_release);
+            }
+            return ready;
+        }
+    }
+}
+
+int mpmc_ring_push(mpmc_ring_t* ring, void* data) {
+    return mpmc_ring_push_batch(ring, &data, 1) == 1;
+}
+
+// 一次 CAS 认领一段连续的已写入槽位，返回实际取出的个数（队列空时为 0）
+size_t mpmc_ring_pop_batch(mpmc_ring_t* ring, void** items, size_t max_count) {
+    if (max_count == 0) {
+        return 0;
+    }
+
+    size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+
+    for (;;) {
+        size_t ready = 0;
+        while (ready < max_count) {
+            mpmc_cell_t* cell = &ring->cells[(pos + ready) & ring->mask];
+            size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+            if (seq != pos + ready + 1) {
+                break;
+            }
+            ready++;
+        }
+
+        if (ready == 0) {
+            mpmc_cell_t* cell = &ring->cells[pos & ring->mask];
+            size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+            if ((ptrdiff_t)(seq - (pos + 1)) < 0) {
+                return 0;
+            }
+            pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&ring->dequeue_pos, &pos, pos + ready,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            for (size_t i = 0; i < ready; i++) {
+                mpmc_cell_t* cell = &ring->cells[(pos + i) & ring->mask];
+                items[i] = cell->data;
+                atomic_store_explicit(&cell->sequence, pos + i + ring->mask + 1, memory_order_release);
+            }
+            return ready;
+        }
+    }
+}
+
+void* mpmc_ring_pop(mpmc_ring_t* ring) {
+    void* data = NULL;
+    if (mpmc_ring_pop_batch(ring, &data, 1) == 0) {
+        return NULL;
+    }
+    return data;
+}
+
+#if defined(TEST)
+int main() {
+    mpsc_queue_t* queue = create_mpsc_queue();
+
+    int values[4] = {1, 2, 3, 4};
+    mpsc_node_t nodes[4];
+    for (int i = 0; i < 4; i++) {
+        nodes[i].data = &values[i];
+    }
+
+    mpsc_queue_push(queue, &nodes[0]);
+
+    // 批量入队：先在本地把节点串起来
+    atomic_store(&nodes[1].next, &nodes[2]);
+    atomic_store(&nodes[2].next, &nodes[3]);
+    mpsc_queue_push_batch(queue, &nodes[1], &nodes[3]);
+
+    mpsc_node_t* node;
+    while ((node = mpsc_queue_pop(queue)) != NULL) {
+        printf("%d ", *(int*)node->data);
+    }
+    printf("\n");
+
+    destroy_mpsc_queue(queue);
+
+    mpmc_ring_t* ring = create_mpmc_ring(4);
+    void* items[4] = {&values[0], &values[1], &values[2], &values[3]};
+    printf("pushed %zu\n", mpmc_ring_push_batch(ring, items, 4));
+    printf("push when full: %d\n", mpmc_ring_push(ring, &values[0]));
+
+    void* out[4];
+    size_t popped = mpmc_ring_pop_batch(ring, out, 4);
+    for (size_t i = 0; i < popped; i++) {
+        printf("%d ", *(int*)out[i]);
+    }
+    printf("\n");
+
+    destroy_mpmc_ring(ring);
+
+    return 0;
+}
+#endif
+
+#if defined(BENCH)
+#include <pthread.h>
+#include <sched.h>
+
+#define BENCH_TOTAL_OPS (BENCH_OPS * 4)
+#define BENCH_BATCH_SIZE 32
+
+typedef struct {
+    mpsc_queue_t* mpsc;
+    mpmc_ring_t* ring;
+    mpsc_node_t* nodes;
+    size_t count;
+    int batched;
+} bench_producer_args;
+
+void* mpsc_producer(void* arg) {
+    bench_producer_args* args = arg;
+
+    if (!args->batched) {
+        for (size_t i = 0; i < args->count; i++) {
+            mpsc_queue_push(args->mpsc, &args->nodes[i]);
+        }
+        return NULL;
+    }
+
+    for (size_t i = 0; i < args->count; i += BENCH_BATCH_SIZE) {
+        size_t end = i + BENCH_BATCH_SIZE < args->count ? i + BENCH_BATCH_SIZE : args->count;
+        for (size_t j = i; j + 1 < end; j++) {
+            atomic_store_explicit(&args->nodes[j].next, &args->nodes[j + 1], memory_order_relaxed);
+        }
+        mpsc_queue_push_batch(args->mpsc, &args->nodes[i], &args->nodes[end - 1]);
+    }
+    return NULL;
+}
+
+void* mpmc_producer(void* arg) {
+    bench_producer_args* args = arg;
+    void* items[BENCH_BATCH_SIZE];
+    size_t batch = args->batched ? BENCH_BATCH_SIZE : 1;
+
+    for (size_t i = 0; i < args->count;) {
+        size_t n = args->count - i < batch ? args->count - i : batch;
+        for (size_t j = 0; j < n; j++) {
+            items[j] = &args->nodes[i + j];
+        }
+        size_t pushed = mpmc_ring_push_batch(args->ring, items, n);
+        if (pushed == 0) {
+            // 队列已满，让出 CPU 给消费者
+            sched_yield();
+        }
+        i += pushed;
+    }
+    return NULL;
+}
+
+// producers 个生产者线程对一个消费者，每个操作是一次入队加一次出队
+void run_bench(int use_ring, int producers, int batched) {
+    size_t per_producer = BENCH_TOTAL_OPS / producers;
+    mpsc_node_t* nodes = malloc(sizeof(mpsc_node_t) * per_producer * producers);
+    bench_producer_args* args = malloc(sizeof(bench_producer_args) * producers);
+    pthread_t* threads = malloc(sizeof(pthread_t) * producers);
+    mpsc_queue_t* mpsc = create_mpsc_queue();
+    mpmc_ring_t* ring = create_mpmc_ring(1 << 16);
+
+    bench_run run;
+    bench_begin(&run, use_ring ? "mpmc_ring" : "mpsc_queue", batched ? "push_pop_batch" : "push_pop", "none");
+
+    // 线程创建失败时只等已经启动的生产者，否则消费者会一直等不到剩下的元素
+    int started = 0;
+    for (int i = 0; i < producers; i++) {
+        args[i].mpsc = mpsc;
+        args[i].ring = ring;
+        args[i].nodes = nodes + i * per_producer;
+        args[i].count = per_producer;
+        args[i].batched = batched;
+        if (pthread_create(&threads[i], NULL, use_ring ? mpmc_producer : mpsc_producer, &args[i]) != 0) {
+            fprintf(stderr, "run_bench: only %d of %d producers started\n", started, producers);
+            break;
+        }
+        started++;
+    }
+    run.threads = started;
+    size_t total = per_producer * started;
+
+    size_t consumed = 0;
+    while (consumed < total) {
+        if (use_ring) {
+            void* items[BENCH_BATCH_SIZE];
+            consumed += mpmc_ring_pop_batch(ring, items, batched ? BENCH_BATCH_SIZE : 1);
+        } else {
+            mpsc_node_t* popped[BENCH_BATCH_SIZE];
+            consumed += mpsc_queue_pop_batch(mpsc, popped, batched ? BENCH_BATCH_SIZE : 1);
+        }
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    bench_end(&run, total);
+
+    destroy_mpmc_ring(ring);
+    destroy_mpsc_queue(mpsc);
+    free(threads);
+    free(args);
+    free(nodes);
+}
+
+int main() {
+    for (int use_ring = 0; use_ring < 2; use_ring++) {
+        for (int batched = 0; batched < 2; batched++) {
+            for (int producers = 1; producers <= 64; producers *= 2) {
+                run_bench(use_ring, producers, batched);
+            }
+        }
+    }
+
+    return 0;
+}
+#endif
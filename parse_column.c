@@ -0,0 +1,235 @@
+#define PARSE_COLUMN_BATCH_SIZE 256
+
+typedef struct {
+    size_t count;        // 无法解析的字段数
+    size_t first_offset; // 第一个无法解析的字段在输入中的偏移，count 为 0 时无意义
+} parse_column_errors;
+
+int is_column_separator(char c, char delimiter) {
+    return c == delimiter || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+#if defined(XSTRTOULL_SWAR)
+// 等于 c 的字节最高位置 1
+uint64_t swar_byte_equal(uint64_t x, unsigned char c) {
+    uint64_t t = x ^ (SWAR_ONES * c);
+    return ~(((t & ~SWAR_HIGHS) + ~SWAR_HIGHS) | t) & SWAR_HIGHS;
+}
+#endif
+
+// 跳过分隔符和空白，一次检查 8 个字节
+const char* skip_column_separators(const char* s, const char* end, char delimiter) {
+#if defined(XSTRTOULL_SWAR)
+    while (end - s >= 8) {
+        uint64_t x = swar_load8(s);
+        uint64_t separators = swar_byte_equal(x, (unsigned char)delimiter) |
+                              swar_byte_equal(x, ' ') | swar_byte_equal(x, '\t') |
+                              swar_byte_equal(x, '\r') | swar_byte_equal(x, '\n');
+        uint64_t others = ~separators & SWAR_HIGHS;
+        if (others != 0) {
+            return s + swar_ctz64(others) / 8;
+        }
+        s += 8;
+    }
+#endif
+    while (s < end && is_column_separator(*s, delimiter)) {
+        s++;
+    }
+    return s;
+}
+
+void record_column_error(parse_column_errors* errors, size_t offset) {
+    if (errors == NULL) {
+        return;
+    }
+    if (errors->count == 0) {
+        errors->first_offset = offset;
+    }
+    errors->count++;
+}
+
+// 解析 buf 中以 delimiter、空白或换行分隔的无符号整数，追加到 out。
+// out 的 element_size 必须是 sizeof(unsigned long long)，否则什么也不解析，
+// 在 errors 里记一个偏移为 0 的错误并返回 0。
+// 字段原地解析、不做拷贝；无法完整解析的字段跳过并记入 errors，errors 可以为 NULL。
+// 溢出的字段与 xstrtoull 一样得到 ULLONG_MAX。返回追加的个数。
+size_t parse_uint64_column(const char* buf, size_t len, char delimiter, unsigned int base,
+                           dynamic_array* out, parse_column_errors* errors) {
+    unsigned long long batch[PARSE_COLUMN_BATCH_SIZE];
+    size_t batch_size = 0;
+    size_t total = 0;
+    const char* end = buf + len;
+    const char* s = buf;
+
+    if (out->element_size != sizeof(unsigned long long)) {
+        record_column_error(errors, 0);
+        return 0;
+    }
+
+    for (;;) {
+        s = skip_column_separators(s, end, delimiter);
+        if (s == end) {
+            break;
+        }
+
+        char* field_end;
+        unsigned long long value = xstrtoull_range(s, end, &field_end, base);
+
+        if (field_end == s || (field_end != end && !is_column_separator(*field_end, delimiter))) {
+            record_column_error(errors, s - buf);
+            while (s < end && !is_column_separator(*s, delimiter)) {
+                s++;
+            }
+            continue;
+        }
+
+        batch[batch_size++] = value;
+        if (batch_size == PARSE_COLUMN_BATCH_SIZE) {
+            push_back_n_dynamic_array(out, batch, batch_size);
+            total += batch_size;
+            batch_size = 0;
+        }
+        s = field_end;
+    }
+
+    push_back_n_dynamic_array(out, batch, batch_size);
+    total += batch_size;
+    return total;
+}
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    const char* buf;
+    size_t begin;
+    size_t end;
+    char delimiter;
+    unsigned int base;
+    dynamic_array* values;
+    parse_column_errors errors;
+    int threaded;
+} parse_column_chunk;
+
+void* parse_column_chunk_worker(void* arg) {
+    parse_column_chunk* chunk = (parse_column_chunk*)arg;
+    parse_uint64_column(chunk->buf + chunk->begin, chunk->end - chunk->begin,
+                        chunk->delimiter, chunk->base, chunk->values, &chunk->errors);
+    chunk->errors.first_offset += chunk->begin;
+    return NULL;
+}
+
+// 把文件映射进内存，按字段边界切成 num_threads 段并行解析，结果按文件顺序追加到 out。
+// out 的 element_size 不是 sizeof(unsigned long long)、打开或映射文件失败时返回 -1，否则返回 0。
+int parse_uint64_column_file(const char* path, char delimiter, unsigned int base, int num_threads,
+                             dynamic_array* out, parse_column_errors* errors) {
+    if (out->element_size != sizeof(unsigned long long)) {
+        record_column_error(errors, 0);
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    size_t len = (size_t)st.st_size;
+    if (len == 0) {
+        close(fd);
+        return 0;
+    }
+
+    const char* buf = (const char*)mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED) {
+        return -1;
+    }
+    madvise((void*)buf, len, MADV_SEQUENTIAL);
+
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    parse_column_chunk* chunks = (parse_column_chunk*)malloc(sizeof(parse_column_chunk) * num_threads);
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * num_threads);
+
+    size_t begin = 0;
+    for (int i = 0; i < num_threads; i++) {
+        size_t end = i == num_threads - 1 ? len : len / num_threads * (i + 1);
+        if (end < begin) {
+            end = begin;
+        }
+        // 分段点向后移到字段边界，保证每个字段只落在一段里
+        while (end < len && end > 0 && !is_column_separator(buf[end - 1], delimiter)) {
+            end++;
+        }
+
+        chunks[i].buf = buf;
+        chunks[i].begin = begin;
+        chunks[i].end = end;
+        chunks[i].delimiter = delimiter;
+        chunks[i].base = base;
+        // 各段在工作线程里增长，arena 之类的分配器不是线程安全的，这里固定用 malloc
+        chunks[i].values = create_dynamic_array(out->element_size);
+        chunks[i].errors.count = 0;
+        chunks[i].errors.first_offset = 0;
+        // 线程创建失败时这一段在当前线程里解析
+        chunks[i].threaded = pthread_create(&threads[i], NULL, parse_column_chunk_worker, &chunks[i]) == 0;
+        if (!chunks[i].threaded) {
+            parse_column_chunk_worker(&chunks[i]);
+        }
+        begin = end;
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        if (chunks[i].threaded) {
+            pthread_join(threads[i], NULL);
+        }
+        push_back_n_dynamic_array(out, chunks[i].values->data, chunks[i].values->size);
+        if (errors != NULL && chunks[i].errors.count != 0) {
+            if (errors->count == 0) {
+                errors->first_offset = chunks[i].errors.first_offset;
+            }
+            errors->count += chunks[i].errors.count;
+        }
+        destroy_dynamic_array(chunks[i].values);
+    }
+
+    free(threads);
+    free(chunks);
+    munmap((void*)buf, len);
+    return 0;
+}
+#endif
+
+// 依赖 strtoull.c 和 dynamic_array.c，因为 strtoull.c 要按 C++ 编译；
+// 示例用单独的宏，避免和被引入文件的 TEST main 冲突：
+//   c++ -DPARSE_COLUMN_TEST -include cstdio -include allocator.c -include strtoull.c -include dynamic_array.c parse_column.c -o test_parse_column -pthread
+#if defined(PARSE_COLUMN_TEST)
+int main() {
+    const char* input = "1, 22,333\n4444 0x10 bad 18446744073709551615,,99999999999999999999\n7";
+    dynamic_array* values = create_dynamic_array(sizeof(unsigned long long));
+    parse_column_errors errors = {0, 0};
+
+    size_t count = parse_uint64_column(input, strlen(input), ',', 0, values, &errors);
+
+    printf("parsed %zu values, %zu errors (first at offset %zu)\n", count, errors.count, errors.first_offset);
+    for (size_t i = 0; i < values->size; i++) {
+        printf("%llu\n", *(unsigned long long*)get_dynamic_array_element(values, i));
+    }
+
+    destroy_dynamic_array(values);
+
+    return 0;
+}
+#endif
@@ -1,4 +1,18 @@
 #include <climits>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * SWAR 快速路径：一次读 8 个字符并行校验、转换。
+ * 逐字节的编码顺序依赖小端序，其他平台只走逐字符的慢路径。
+ */
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define XSTRTOULL_SWAR 1
+#endif
 
 int xisdigit(const int ch)
 {
@@ -21,30 +35,176 @@ char xtolower(const char c)
 	return c | 0x20;
 }
 
-const char *parse_integer_fixup_radix(const char *s, unsigned int *base)
+/* end 为 nullptr 时按 '\0' 结尾的字符串处理，否则不会读到 end 及之后的字节 */
+const char *parse_integer_fixup_radix_range(const char *s, const char *end, unsigned int *base)
 {
+	const size_t avail = end ? (size_t)(end - s) : SIZE_MAX;
+	const int zero_x = avail >= 2 && s[0] == '0' && xtolower(s[1]) == 'x';
+
 	if (*base == 0) {
-		if (s[0] == '0') {
-			if (xtolower(s[1]) == 'x' && isxdigit(s[2]))
+		if (avail >= 1 && s[0] == '0') {
+			if (zero_x && avail >= 3 && isxdigit(s[2]))
 				*base = 16;
 			else
 				*base = 8;
 		} else
 			*base = 10;
 	}
-	if (*base == 16 && s[0] == '0' && xtolower(s[1]) == 'x')
+	if (*base == 16 && zero_x)
 		s += 2;
 	return s;
 }
 
-unsigned long long xstrtoull(const char *nptr, char **endptr, unsigned int base) {
-    const char *s = parse_integer_fixup_radix(nptr, &base);
+const char *parse_integer_fixup_radix(const char *s, unsigned int *base)
+{
+	return parse_integer_fixup_radix_range(s, nullptr, base);
+}
+
+#if defined(XSTRTOULL_SWAR)
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+
+/* 剩余长度足够时才整块读取，end 必须是已知的结尾，不能越过对象边界 */
+int swar_can_load8(const char *s, const char *end)
+{
+	return end - s >= 8;
+}
+
+uint64_t swar_load8(const char *s)
+{
+	uint64_t x;
+	memcpy(&x, s, sizeof(x));
+	return x;
+}
+
+unsigned int swar_ctz64(uint64_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return index;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+/* 每个字节落在 [lo, hi] 内时该字节最高位置 1，要求 x 的每个字节都小于 0x80 */
+uint64_t swar_in_range(uint64_t x, unsigned char lo, unsigned char hi)
+{
+	return (x + SWAR_ONES * (0x80 - lo)) & ~(x + SWAR_ONES * (0x7f - hi)) & SWAR_HIGHS;
+}
+
+/* 第一个非数字字符之前有几个数字字符（0 到 8） */
+unsigned int swar_decimal_prefix(uint64_t x)
+{
+	uint64_t digits = swar_in_range(x & ~SWAR_HIGHS, '0', '9') & ~x;
+	uint64_t others = ~digits & SWAR_HIGHS;
+	return others ? swar_ctz64(others) / 8 : 8;
+}
+
+unsigned int swar_hex_prefix(uint64_t x, uint64_t *alpha)
+{
+	uint64_t low = x & ~SWAR_HIGHS;
+	uint64_t digits = swar_in_range(low, '0', '9');
+	*alpha = swar_in_range(low | SWAR_ONES * 0x20, 'a', 'f') & ~x;
+	uint64_t others = ~((digits & ~x) | *alpha) & SWAR_HIGHS;
+	return others ? swar_ctz64(others) / 8 : 8;
+}
+
+/* 8 个 ASCII 十进制数字转成整数，第一个字符是最高位 */
+uint64_t swar_decimal8(uint64_t x)
+{
+	x -= SWAR_ONES * '0';
+	x = (x * 10 + (x >> 8)) & 0x00ff00ff00ff00ffULL;
+	x = (x * 100 + (x >> 16)) & 0x0000ffff0000ffffULL;
+	return (x * 10000 + (x >> 32)) & 0xffffffffULL;
+}
+
+/* 8 个 ASCII 十六进制数字转成整数，alpha 标记了哪些字节是字母 */
+uint64_t swar_hex8(uint64_t x, uint64_t alpha)
+{
+	x = (x & SWAR_ONES * 0x0f) + (alpha >> 7) * 9;
+	x = ((x << 4) | (x >> 8)) & 0x00ff00ff00ff00ffULL;
+	x = ((x << 8) | (x >> 16)) & 0x0000ffff0000ffffULL;
+	return ((x << 16) | (x >> 32)) & 0xffffffffULL;
+}
+
+const unsigned long long swar_pow10[9] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL,
+	100000ULL, 1000000ULL, 10000000ULL, 100000000ULL
+};
+
+const char *swar_parse_decimal(const char *s, const char *end, unsigned long long *acc, int *any)
+{
+	for (unsigned int total = 0; total < 16 && swar_can_load8(s, end);) {
+		uint64_t x = swar_load8(s);
+		unsigned int n = swar_decimal_prefix(x);
+		if (n == 0)
+			break;
+		/* 不足 8 位时把数字移到高字节，低字节补 '0' 作前导零 */
+		if (n < 8)
+			x = (x << (8 * (8 - n))) | (SWAR_ONES * '0' >> (8 * n));
+		*acc = *acc * swar_pow10[n] + swar_decimal8(x);
+		*any = 1;
+		s += n;
+		total += n;
+		if (n < 8)
+			break;
+	}
+	return s;
+}
+
+const char *swar_parse_hex(const char *s, const char *end, unsigned long long *acc, int *any)
+{
+	for (unsigned int total = 0; total < 16 && swar_can_load8(s, end);) {
+		uint64_t alpha;
+		uint64_t x = swar_load8(s);
+		unsigned int n = swar_hex_prefix(x, &alpha);
+		if (n == 0)
+			break;
+		if (n < 8) {
+			x = (x << (8 * (8 - n))) | (SWAR_ONES * '0' >> (8 * n));
+			alpha <<= 8 * (8 - n);
+		}
+		*acc = (*acc << (4 * n)) | swar_hex8(x, alpha);
+		*any = 1;
+		s += n;
+		total += n;
+		if (n < 8)
+			break;
+	}
+	return s;
+}
+#endif
+
+/*
+ * 只解析 [nptr, end) 内的字符，供按长度切分、不以 '\0' 结尾的缓冲区原地解析；
+ * end 为 nullptr 时与 xstrtoull 相同。
+ */
+unsigned long long xstrtoull_range(const char *nptr, const char *end, char **endptr, unsigned int base) {
+    const char *s = parse_integer_fixup_radix_range(nptr, end, &base);
     unsigned long long acc;
     const unsigned long long cutoff = ULLONG_MAX / base;
     const unsigned long long cutlim = ULLONG_MAX % base;
     int any = 0;
 
-    for (acc = 0;; s++) {
+    acc = 0;
+#if defined(XSTRTOULL_SWAR)
+    /*
+     * 最多先吃掉 16 位十进制或 16 位十六进制数字，此时 acc 一定不会溢出；
+     * 剩下靠近 ULLONG_MAX 的数字交给下面带溢出检查的循环。
+     */
+    if (base == 10 || base == 16) {
+        /* 没有 end 时先在 16 个字符内找 '\0'，整块读取不会越过字符串结尾 */
+        const char *swar_end = end ? end : s + strnlen(s, 16);
+        if (base == 10)
+            s = swar_parse_decimal(s, swar_end, &acc, &any);
+        else
+            s = swar_parse_hex(s, swar_end, &acc, &any);
+    }
+#endif
+
+    for (; s != end; s++) {
         unsigned char c = xtolower(*s);
         if (!isxdigit(c))
             break;
@@ -72,3 +232,116 @@ unsigned long long xstrtoull(const char *nptr, char **endptr, unsigned int base)
 
     return acc;
 }
+
+unsigned long long xstrtoull(const char *nptr, char **endptr, unsigned int base) {
+    return xstrtoull_range(nptr, nullptr, endptr, base);
+}
+
+#if defined(TEST)
+#include <cstdio>
+
+int main()
+{
+    const char *inputs[] = {
+        "0", "7", "12345678", "123456789", "1234567890123456",
+        "18446744073709551615", "18446744073709551616", "99999999999999999999999",
+        "00000000000000000000000000042", "4294967296,17", "ffffFFFF", "0x1234abcdEF",
+        "0xffffffffffffffff", "0x10000000000000000", "12abc", "abc"
+    };
+    unsigned int bases[] = {
+        10, 10, 10, 10, 10,
+        10, 10, 10,
+        10, 10, 16, 0,
+        0, 0, 10, 10
+    };
+
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        char *end;
+        unsigned long long value = xstrtoull(inputs[i], &end, bases[i]);
+        printf("%s -> %llu (consumed %d)\n", inputs[i], value, (int)(end - inputs[i]));
+    }
+
+    return 0;
+}
+#endif
+
+#if defined(BENCH)
+/* 把 count 个数字按 format 写成以 '\0' 分隔的字符串，*offsets 返回每个数字的起始位置 */
+char *format_numbers(const unsigned long long *values, size_t count, const char *format, size_t **offsets)
+{
+    char *buffer = (char *)malloc(count * 24);
+    size_t pos = 0;
+    *offsets = (size_t *)malloc(sizeof(size_t) * count);
+    for (size_t i = 0; i < count; i++) {
+        (*offsets)[i] = pos;
+        pos += snprintf(buffer + pos, 24, format, values[i]) + 1;
+    }
+    return buffer;
+}
+
+int main()
+{
+    const char *dists[BENCH_DIST_COUNT + 1] = {
+        bench_dist_names[BENCH_DIST_SEQUENTIAL], bench_dist_names[BENCH_DIST_UNIFORM],
+        bench_dist_names[BENCH_DIST_ZIPFIAN], "uniform64"
+    };
+    bench_run run;
+
+    for (int dist = 0; dist <= BENCH_DIST_COUNT; dist++) {
+        unsigned long long *values;
+        if (dist < BENCH_DIST_COUNT) {
+            values = bench_keys((bench_dist)dist, BENCH_OPS, BENCH_OPS, 1);
+        } else {
+            /* 各种位数都有的 64 位值，包括接近 ULLONG_MAX 的 */
+            unsigned long long state = 1;
+            values = (unsigned long long *)malloc(sizeof(unsigned long long) * BENCH_OPS);
+            for (size_t i = 0; i < BENCH_OPS; i++) {
+                unsigned long long x = bench_random(&state);
+                values[i] = x >> (x % 64);
+            }
+        }
+
+        size_t *offsets;
+        char *decimal = format_numbers(values, BENCH_OPS, "%llu", &offsets);
+        unsigned long long sum = 0;
+
+        bench_begin(&run, "xstrtoull", "decimal", dists[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            sum += xstrtoull(decimal + offsets[i], nullptr, 10);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        bench_begin(&run, "libc_strtoull", "decimal", dists[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            sum -= strtoull(decimal + offsets[i], nullptr, 10);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        free(offsets);
+        free(decimal);
+
+        char *hex = format_numbers(values, BENCH_OPS, "%llx", &offsets);
+
+        bench_begin(&run, "xstrtoull", "hex", dists[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            sum += xstrtoull(hex + offsets[i], nullptr, 16);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        bench_begin(&run, "libc_strtoull", "hex", dists[dist]);
+        for (size_t i = 0; i < BENCH_OPS; i++) {
+            sum -= strtoull(hex + offsets[i], nullptr, 16);
+        }
+        bench_end(&run, BENCH_OPS);
+
+        /* 两种实现结果一致时 sum 为 0 */
+        fprintf(stderr, "xstrtoull %s: checksum %llu\n", dists[dist], sum);
+
+        free(offsets);
+        free(hex);
+        free(values);
+    }
+
+    return 0;
+}
+#endif